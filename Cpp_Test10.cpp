@@ -5,10 +5,191 @@
 #include <algorithm>
 #include <chrono>
 #include <cstring>
+#include <cstdint>
+#include <string>
 
-// You can change this block size for experiments.
-constexpr int BLOCK_SIZE = 1048;
-constexpr int INSERTION_SORT_THRESHOLD = 32;
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "min_max_sort.h"
+
+// Эталонная копия сортировки с поэтапными счётчиками: всё в безымянном
+// пространстве имён, чтобы замер собирался вместе с библиотекой hmm без
+// конфликтов символов
+namespace {
+
+// Пороги берутся из профиля библиотеки (hmm_tuning_profile): встроенные
+// значения, hmm_tuned.h при -DHMM_USE_TUNED_HEADER или HMM_TUNING_FILE.
+// Порог вставок служит и размером блоков вставок в запасной сортировке слиянием
+const hmm_tuning_params& int_params() {
+    return hmm_tuning_profile.int_params;
+}
+
+const hmm_tuning_params& double_params() {
+    return hmm_tuning_profile.double_params;
+}
+
+
+// ------------------ Hardware performance counters ------------------
+
+// Счётчики perf_event_open: каждое событие открывается отдельно, поэтому
+// недоступные (в контейнере, в ВМ, при perf_event_paranoid) просто
+// пропускаются и печатаются как n/a
+class PerfCounters {
+public:
+    static constexpr int kEvents = 6;
+
+    PerfCounters() {
+        for (int i = 0; i < kEvents; i++)
+            fds_[i] = open_event(i);
+    }
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_)
+            if (fd >= 0)
+                close(fd);
+#endif
+    }
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const {
+        for (int fd : fds_)
+            if (fd >= 0)
+                return true;
+        return false;
+    }
+
+    bool has(int i) const {
+        return fds_[i] >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd < 0)
+                continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        for (int fd : fds_)
+            if (fd >= 0)
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+    // Текущие значения с поправкой на мультиплексирование; -1 – событие недоступно
+    void read_values(int64_t out[kEvents]) const {
+        for (int i = 0; i < kEvents; i++) {
+            out[i] = -1;
+#ifdef __linux__
+            uint64_t buf[3];
+            if (fds_[i] < 0 || read(fds_[i], buf, sizeof(buf)) != sizeof(buf))
+                continue;
+            double scale = (buf[2] > 0 && buf[2] < buf[1]) ? (double)buf[1] / buf[2] : 1.0;
+            out[i] = (int64_t)(buf[0] * scale);
+#endif
+        }
+    }
+
+    static const char* name(int i) {
+        static const char* names[kEvents] = {
+            "cycles", "instr", "br-miss", "L1d-miss", "LLC-miss", "dTLB-miss"
+        };
+        return names[i];
+    }
+
+private:
+    int fds_[kEvents];
+
+    static int open_event(int i) {
+#ifdef __linux__
+        static const uint32_t types[kEvents] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+            PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE
+        };
+        static const uint64_t configs[kEvents] = {
+            PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES,
+            PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+            PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+        };
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = types[i];
+        attr.config = configs[i];
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+#else
+        (void)i;
+        return -1;
+#endif
+    }
+};
+
+// Печать счётчиков в пересчёте на элемент
+void print_counters_per_element(const char* label, const int64_t values[PerfCounters::kEvents], int n) {
+    std::cout << "    " << label << ":";
+    for (int i = 0; i < PerfCounters::kEvents; i++) {
+        std::cout << " " << PerfCounters::name(i) << "/elem=";
+        if (values[i] < 0)
+            std::cout << "n/a";
+        else
+            std::cout << (double)values[i] / n;
+    }
+    std::cout << "\n";
+}
+
+// Поэтапные счётчики для гибридной сортировки (--perf-phases). Каждая граница
+// этапа читает все счётчики, поэтому режим заметно замедляет сортировку –
+// важны доли этапов, а не абсолютное время
+enum Phase { PHASE_PIVOT, PHASE_PARTITION, PHASE_INSERTION, PHASE_MERGE, PHASE_COUNT };
+
+struct PhaseProfile {
+    PerfCounters* counters = nullptr;
+    int64_t totals[PHASE_COUNT][PerfCounters::kEvents] = {};
+};
+
+PhaseProfile* g_phase_profile = nullptr;
+
+class PhaseScope {
+public:
+    explicit PhaseScope(Phase phase) : phase_(phase) {
+        if (g_phase_profile)
+            g_phase_profile->counters->read_values(begin_);
+    }
+    ~PhaseScope() {
+        if (!g_phase_profile)
+            return;
+        int64_t end[PerfCounters::kEvents];
+        g_phase_profile->counters->read_values(end);
+        for (int i = 0; i < PerfCounters::kEvents; i++)
+            if (end[i] >= 0 && begin_[i] >= 0)
+                g_phase_profile->totals[phase_][i] += end[i] - begin_[i];
+    }
+
+private:
+    Phase phase_;
+    int64_t begin_[PerfCounters::kEvents];
+};
+
+bool g_perf_enabled = true;
+bool g_perf_phases = false;
 
 // ------------------ Functions for int ------------------
 
@@ -25,7 +206,8 @@ void insertion_sort(int arr[], int low, int high) {
 }
 
 int get_adaptive_threshold(int segment_size) {
-    return (segment_size < 64) ? segment_size : 64;
+    int threshold = int_params().insertion_threshold;
+    return (segment_size < threshold) ? segment_size : threshold;
 }
 
 int median_of_five_index(const int arr[], int i1, int i2, int i3, int i4, int i5) {
@@ -89,7 +271,7 @@ void counting_sort_for_radix(int arr[], int n, int exp) {
 }
 
 int select_lower_pivot(const int arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
+    if (segment_size < int_params().median5_threshold) {
         int i1 = left;
         int i2 = left + segment_size / 4;
         int i3 = left + segment_size / 2;
@@ -105,7 +287,7 @@ int select_lower_pivot(const int arr[], int left, int right, int segment_size) {
 }
 
 int select_upper_pivot(const int arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
+    if (segment_size < int_params().median5_threshold) {
         int i1 = left + segment_size / 2;
         int i2 = left + (3 * segment_size) / 4;
         int i3 = right;
@@ -120,28 +302,6 @@ int select_upper_pivot(const int arr[], int left, int right, int segment_size) {
     }
 }
 
-void merge(int arr[], int left, int mid, int right) {
-    int n1 = mid - left + 1, n2 = right - mid;
-    std::vector<int> L(n1), R(n2);
-    
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = arr[mid + 1 + j];
-    
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j])
-            arr[k++] = L[i++];
-        else
-            arr[k++] = R[j++];
-    }
-    while (i < n1)
-        arr[k++] = L[i++];
-    while (j < n2)
-        arr[k++] = R[j++];
-}
-
 // Оптимизированная сортировка слиянием (используется как fallback)
 // Шаблонные функции: insertion_sort_opt, merge_opt, merge_sort_opt
 template <typename T>
@@ -175,15 +335,15 @@ void merge_opt(T* arr, int left, int mid, int right, std::vector<T>& buffer) {
 }
 
 template <typename T>
-void merge_sort_opt(T* arr, int n) {
+void merge_sort_opt(T* arr, int n, int block) {
     std::vector<T> buffer(n);
     // Сортируем мелкие блоки вставками
-    for (int i = 0; i < n; i += INSERTION_SORT_THRESHOLD) {
-        int right = std::min(i + INSERTION_SORT_THRESHOLD - 1, n - 1);
+    for (int i = 0; i < n; i += block) {
+        int right = std::min(i + block - 1, n - 1);
         insertion_sort_opt(arr, i, right);
     }
     // Итеративное объединение блоков
-    for (int step = INSERTION_SORT_THRESHOLD; step < n; step *= 2) {
+    for (int step = block; step < n; step *= 2) {
         for (int left = 0; left < n - step; left += 2 * step) {
             int mid = left + step - 1;
             int right = std::min(left + 2 * step - 1, n - 1);
@@ -197,39 +357,48 @@ void hybrid_min_max_sort_serial(int arr[], int left, int right, int /*k*/) {
     int segment_size = right - left + 1;
     int threshold = get_adaptive_threshold(segment_size);
     if (segment_size <= threshold) {
+        PhaseScope scope(PHASE_INSERTION);
         insertion_sort(arr, left, right);
         return;
     }
     
-    int i_med_low = select_lower_pivot(arr, left, right, segment_size);
-    int lowerPivot = arr[i_med_low];
-    
-    int i_med_high = select_upper_pivot(arr, left, right, segment_size);
-    int upperPivot = arr[i_med_high];
-    
-    if (lowerPivot > upperPivot) {
-        std::swap(arr[i_med_low], arr[i_med_high]);
+    int lowerPivot, upperPivot;
+    {
+        PhaseScope scope(PHASE_PIVOT);
+        int i_med_low = select_lower_pivot(arr, left, right, segment_size);
         lowerPivot = arr[i_med_low];
+        
+        int i_med_high = select_upper_pivot(arr, left, right, segment_size);
         upperPivot = arr[i_med_high];
+        
+        if (lowerPivot > upperPivot) {
+            std::swap(arr[i_med_low], arr[i_med_high]);
+            lowerPivot = arr[i_med_low];
+            upperPivot = arr[i_med_high];
+        }
     }
     
     int l = left, r = right;
-    for (int i = left; i <= r;) {
-        if (arr[i] < lowerPivot) {
-            std::swap(arr[i], arr[l]);
-            l++;
-            i++;
-        } else if (arr[i] > upperPivot) {
-            std::swap(arr[i], arr[r]);
-            r--;
-        } else {
-            i++;
+    {
+        PhaseScope scope(PHASE_PARTITION);
+        for (int i = left; i <= r;) {
+            if (arr[i] < lowerPivot) {
+                std::swap(arr[i], arr[l]);
+                l++;
+                i++;
+            } else if (arr[i] > upperPivot) {
+                std::swap(arr[i], arr[r]);
+                r--;
+            } else {
+                i++;
+            }
         }
     }
     
     // Если разбиение оказалось неэффективным, используем оптимизированную merge sort
     if (l == left || r == right) {
-        merge_sort_opt(arr + left, right - left + 1);
+        PhaseScope scope(PHASE_MERGE);
+        merge_sort_opt(arr + left, right - left + 1, int_params().insertion_threshold);
         return;
     }
     
@@ -257,7 +426,8 @@ bool is_sorted(const int arr[], int n) {
 }
 
 int compare_int(const void *a, const void *b) {
-    return (*(int*)a - *(int*)b);
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y); // разность x - y переполняется
 }
 
 void radix_sort(int arr[], int n) {
@@ -279,25 +449,42 @@ void test_hybrid_sort_int(int n) {
     copy_array(original.data(), arrRadix.data(), n);
     copy_array(original.data(), arrStd.data(), n);
     
+    PerfCounters counters;
+    bool perf = g_perf_enabled && counters.available();
+    int64_t cHybrid[PerfCounters::kEvents], cQSort[PerfCounters::kEvents];
+    int64_t cRadix[PerfCounters::kEvents], cStd[PerfCounters::kEvents];
+    
     auto start = std::chrono::high_resolution_clock::now();
+    if (perf) counters.start();
     hybrid_min_max_sort_serial(arrHybrid.data(), 0, n - 1, 2);
+    if (perf) counters.stop();
     auto end = std::chrono::high_resolution_clock::now();
     double timeHybrid = std::chrono::duration<double>(end - start).count();
+    counters.read_values(cHybrid);
     
     auto start_qsort = std::chrono::high_resolution_clock::now();
+    if (perf) counters.start();
     std::qsort(arrQSort.data(), n, sizeof(int), compare_int);
+    if (perf) counters.stop();
     auto end_qsort = std::chrono::high_resolution_clock::now();
     double timeQSort = std::chrono::duration<double>(end_qsort - start_qsort).count();
+    counters.read_values(cQSort);
     
     auto start_radix = std::chrono::high_resolution_clock::now();
+    if (perf) counters.start();
     radix_sort(arrRadix.data(), n);
+    if (perf) counters.stop();
     auto end_radix = std::chrono::high_resolution_clock::now();
     double timeRadix = std::chrono::duration<double>(end_radix - start_radix).count();
+    counters.read_values(cRadix);
     
     auto start_std = std::chrono::high_resolution_clock::now();
+    if (perf) counters.start();
     std::sort(arrStd.begin(), arrStd.end());
+    if (perf) counters.stop();
     auto end_std = std::chrono::high_resolution_clock::now();
     double timeStd = std::chrono::duration<double>(end_std - start_std).count();
+    counters.read_values(cStd);
     
     std::cout << "===== Тест для int, размер массива: " << n << " =====\n";
     std::cout << "Hybrid Min-Max Sort: " << timeHybrid << " сек, Отсортировано: " 
@@ -307,7 +494,37 @@ void test_hybrid_sort_int(int n) {
     std::cout << "Radix Sort: " << timeRadix << " сек, Отсортировано: " 
               << (is_sorted(arrRadix.data(), n) ? "ДА" : "НЕТ") << "\n";
     std::cout << "std::sort: " << timeStd << " сек, Отсортировано: " 
-              << (is_sorted(arrStd.data(), n) ? "ДА" : "НЕТ") << "\n\n";
+              << (is_sorted(arrStd.data(), n) ? "ДА" : "НЕТ") << "\n";
+    
+    if (perf) {
+        std::cout << "  Аппаратные счётчики на элемент:\n";
+        print_counters_per_element("Hybrid", cHybrid, n);
+        print_counters_per_element("QSort", cQSort, n);
+        print_counters_per_element("Radix", cRadix, n);
+        print_counters_per_element("std::sort", cStd, n);
+    } else if (g_perf_enabled) {
+        std::cout << "  Аппаратные счётчики недоступны (perf_event_open)\n";
+    }
+    
+    if (perf && g_perf_phases) {
+        // Повторный прогон гибридной сортировки с разбивкой по этапам
+        static const char* phase_names[PHASE_COUNT] = { "pivot", "partition", "insertion", "merge" };
+        PhaseProfile profile;
+        profile.counters = &counters;
+        for (int p = 0; p < PHASE_COUNT; p++)
+            for (int i = 0; i < PerfCounters::kEvents; i++)
+                profile.totals[p][i] = counters.has(i) ? 0 : -1;
+        copy_array(original.data(), arrHybrid.data(), n);
+        counters.start();
+        g_phase_profile = &profile;
+        hybrid_min_max_sort_serial(arrHybrid.data(), 0, n - 1, 2);
+        g_phase_profile = nullptr;
+        counters.stop();
+        std::cout << "  Этапы Hybrid Min-Max Sort:\n";
+        for (int p = 0; p < PHASE_COUNT; p++)
+            print_counters_per_element(phase_names[p], profile.totals[p], n);
+    }
+    std::cout << "\n";
 }
 
 // ------------------ Functions for double ------------------
@@ -357,7 +574,7 @@ int median_of_three_index_double(const double arr[], int i1, int i2, int i3) {
 }
 
 int select_lower_pivot_double(const double arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
+    if (segment_size < double_params().median5_threshold) {
         int i1 = left;
         int i2 = left + segment_size / 4;
         int i3 = left + segment_size / 2;
@@ -373,7 +590,7 @@ int select_lower_pivot_double(const double arr[], int left, int right, int segme
 }
 
 int select_upper_pivot_double(const double arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
+    if (segment_size < double_params().median5_threshold) {
         int i1 = left + segment_size / 2;
         int i2 = left + (3 * segment_size) / 4;
         int i3 = right;
@@ -388,32 +605,10 @@ int select_upper_pivot_double(const double arr[], int left, int right, int segme
     }
 }
 
-void merge_double(double arr[], int left, int mid, int right) {
-    int n1 = mid - left + 1, n2 = right - mid;
-    std::vector<double> L(n1), R(n2);
-    
-    for (int i = 0; i < n1; i++)
-        L[i] = arr[left + i];
-    for (int j = 0; j < n2; j++)
-        R[j] = arr[mid + 1 + j];
-    
-    int i = 0, j = 0, k = left;
-    while (i < n1 && j < n2) {
-        if (L[i] <= R[j])
-            arr[k++] = L[i++];
-        else
-            arr[k++] = R[j++];
-    }
-    while (i < n1)
-        arr[k++] = L[i++];
-    while (j < n2)
-        arr[k++] = R[j++];
-}
-
 // Гибридная сортировка для double с использованием оптимизированной merge sort при fallback
 void hybrid_min_max_sort_serial_double(double arr[], int left, int right, int /*k*/) {
     int segment_size = right - left + 1;
-    int threshold = get_adaptive_threshold(segment_size);
+    int threshold = std::min(segment_size, double_params().insertion_threshold);
     if (segment_size <= threshold) {
         insertion_sort_double(arr, left, right);
         return;
@@ -446,7 +641,7 @@ void hybrid_min_max_sort_serial_double(double arr[], int left, int right, int /*
     }
     
     if (l == left || r == right) {
-        merge_sort_opt(arr + left, right - left + 1);
+        merge_sort_opt(arr + left, right - left + 1, double_params().insertion_threshold);
         return;
     }
     
@@ -474,8 +669,8 @@ bool is_sorted_double(const double arr[], int n) {
 }
 
 int compare_double(const void *a, const void *b) {
-    double diff = (*(double*)a - *(double*)b);
-    return (diff < 0) ? -1 : (diff > 0) ? 1 : 0;
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
 }
 
 void test_hybrid_sort_double(int n) {
@@ -513,9 +708,20 @@ void test_hybrid_sort_double(int n) {
               << (is_sorted_double(arrStd.data(), n) ? "ДА" : "НЕТ") << "\n\n";
 }
 
+} // namespace
+
 // ------------------ main ------------------
 
-int main() {
+int main(int argc, char* argv[]) {
+    // --no-perf отключает аппаратные счётчики, --perf-phases добавляет разбивку по этапам
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--no-perf")
+            g_perf_enabled = false;
+        else if (arg == "--perf-phases")
+            g_perf_phases = true;
+    }
+    hmm_tuning_init();
     std::srand(static_cast<unsigned>(std::time(nullptr)));
     
     // Тесты для int
@@ -0,0 +1,221 @@
+/*
+ * hmm_perf_gate.cpp
+ *
+ * Проверка производительности: для каждого распределения и типа замеряется
+ * пропускная способность библиотеки и std::sort на одних и тех же данных.
+ * Сравнивается отношение времён (hmm / std::sort) – оно почти не зависит от
+ * машины, поэтому базу можно хранить в репозитории. Случай считается
+ * регрессией, если время библиотеки превысило base * (1 + tolerance) времён
+ * std::sort больше чем на noise_floor секунд; тогда код возврата 1. Без
+ * порога случаи с крошечным отношением (sorted, all_equal) срабатывали бы
+ * от шума таймера.
+ *
+ *   hmm_perf_gate [--baseline файл] [--tolerance 0.5] [--noise-floor 0.001]
+ *                 [--n 1000000] [--update]
+ *
+ * --update перезаписывает базу текущими отношениями.
+ */
+
+#include "min_max_sort.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const kPatternNames[HMM_PATTERN_COUNT] = {
+    "random", "sorted", "reverse", "organ_pipe", "sawtooth",
+    "all_equal", "few_unique", "median3_killer", "pivot_killer"
+};
+
+// Каждая сторона замеряется не менее kMinReps раз и не меньше kMinSeconds
+// суммарно; берётся лучшее время
+const int kMinReps = 5;
+const double kMinSeconds = 0.2;
+
+double now_seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int compare_int(const void* a, const void* b) {
+    int x = *static_cast<const int*>(a), y = *static_cast<const int*>(b);
+    return (x > y) - (x < y);
+}
+
+struct gate_result {
+    double hmm_seconds;
+    double std_seconds;
+    bool sorted;
+};
+
+// Лучшее время sort(copy) на копиях input; копирование в замер не входит
+template <typename T, typename Sort>
+double best_time(const std::vector<T>& input, std::vector<T>& work, Sort sort) {
+    double best = 1e30, total = 0;
+    for (int rep = 0; rep < kMinReps || total < kMinSeconds; rep++) {
+        work = input;
+        double start = now_seconds();
+        sort(work);
+        double t = now_seconds() - start;
+        best = std::min(best, t);
+        total += t;
+    }
+    return best;
+}
+
+template <typename T, typename Sort>
+gate_result measure(const std::vector<T>& input, Sort sort) {
+    std::vector<T> work, expected;
+    gate_result r;
+    r.std_seconds = best_time(input, expected, [](std::vector<T>& v) { std::sort(v.begin(), v.end()); });
+    r.hmm_seconds = best_time(input, work, sort);
+    r.sorted = std::memcmp(work.data(), expected.data(), work.size() * sizeof(T)) == 0;
+    return r;
+}
+
+template <typename T>
+std::vector<T> convert(const std::vector<int>& input) {
+    return std::vector<T>(input.begin(), input.end());
+}
+
+std::map<std::string, double> load_baseline(const std::string& path) {
+    std::map<std::string, double> baseline;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string name;
+        double ratio;
+        if (fields >> name >> ratio)
+            baseline[name] = ratio;
+    }
+    return baseline;
+}
+
+bool save_baseline(const std::string& path, const std::vector<std::pair<std::string, double>>& ratios, int n) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << "# База hmm_perf_gate: отношение времени сортировки библиотеки ко времени\n"
+        << "# std::sort на тех же данных (меньше – быстрее), n = " << n << ".\n"
+        << "# Обновление: hmm_perf_gate --update --baseline <этот файл>\n";
+    for (const auto& entry : ratios) {
+        char ratio[32];
+        std::snprintf(ratio, sizeof(ratio), "%.3f", entry.second);
+        out << entry.first << " " << ratio << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string baseline_path = "hmm_perf_baseline.txt";
+    double tolerance = 0.5;
+    double noise_floor = 0.001;
+    int n = 1000000;
+    bool update = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--baseline" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = std::atof(argv[++i]);
+        else if (arg == "--noise-floor" && i + 1 < argc)
+            noise_floor = std::atof(argv[++i]);
+        else if (arg == "--n" && i + 1 < argc)
+            n = std::atoi(argv[++i]);
+        else if (arg == "--update")
+            update = true;
+        else {
+            std::cerr << "Использование: " << argv[0]
+                      << " [--baseline файл] [--tolerance доля] [--noise-floor секунды]"
+                      << " [--n размер] [--update]\n";
+            return 2;
+        }
+    }
+
+    std::vector<std::pair<std::string, gate_result>> results;
+    for (int kind = 0; kind < HMM_PATTERN_COUNT; kind++) {
+        // Генератор PIVOT_KILLER квадратичен – для него массив в 8 раз меньше
+        int size = (kind == HMM_PATTERN_PIVOT_KILLER) ? n / 8 : n;
+        std::vector<int> input(size);
+        hmm_generate_pattern(input.data(), size, kind, 1);
+        std::string pattern = kPatternNames[kind];
+        results.emplace_back("int/" + pattern, measure(input, [](std::vector<int>& v) {
+            hybrid_min_max_sort_serial(v.data(), 0, static_cast<int>(v.size()) - 1, 2);
+        }));
+        if (kind != HMM_PATTERN_RANDOM && kind != HMM_PATTERN_FEW_UNIQUE)
+            continue;
+        results.emplace_back("double/" + pattern, measure(convert<double>(input), [](std::vector<double>& v) {
+            hmm::sort(v);
+        }));
+        results.emplace_back("total_double/" + pattern, measure(convert<double>(input), [](std::vector<double>& v) {
+            hmm::sort_total(v);
+        }));
+        results.emplace_back("total_float/" + pattern, measure(convert<float>(input), [](std::vector<float>& v) {
+            hmm::sort_total(v);
+        }));
+        results.emplace_back("qsort/" + pattern, measure(input, [](std::vector<int>& v) {
+            hmm_qsort(v.data(), v.size(), sizeof(int), compare_int);
+        }));
+        results.emplace_back("cxx/" + pattern, measure(input, [](std::vector<int>& v) {
+            hmm::hybrid_min_max_sort(v, 0, static_cast<int>(v.size()) - 1, 2);
+        }));
+    }
+
+    std::map<std::string, double> baseline = load_baseline(baseline_path);
+    std::vector<std::pair<std::string, double>> ratios;
+    int failures = 0;
+    // Заголовок выровнен вручную: ширина в printf считается в байтах, а не в буквах
+    std::printf("случай                       hmm, Мэл/с   std, Мэл/с   отнош.     база\n");
+    for (const auto& entry : results) {
+        const std::string& name = entry.first;
+        const gate_result& r = entry.second;
+        double elems = (name == "int/pivot_killer") ? n / 8 : n;
+        double ratio = r.hmm_seconds / r.std_seconds;
+        ratios.emplace_back(name, ratio);
+        std::printf("%-26s %12.1f %12.1f %8.3f ", name.c_str(),
+                    elems / r.hmm_seconds / 1e6, elems / r.std_seconds / 1e6, ratio);
+        auto it = baseline.find(name);
+        const char* verdict = "";
+        if (!r.sorted) {
+            verdict = "НЕ ОТСОРТИРОВАНО";
+            failures++;
+        } else if (update) {
+            verdict = "";
+        } else if (it == baseline.end()) {
+            verdict = "нет в базе";
+        } else if (r.hmm_seconds > it->second * (1 + tolerance) * r.std_seconds + noise_floor) {
+            verdict = "РЕГРЕССИЯ";
+            failures++;
+        }
+        if (it != baseline.end())
+            std::printf("%8.3f %s\n", it->second, verdict);
+        else
+            std::printf("%8s %s\n", "-", verdict);
+    }
+
+    if (update) {
+        if (!save_baseline(baseline_path, ratios, n)) {
+            std::cerr << "Не удалось записать " << baseline_path << "\n";
+            return 2;
+        }
+        std::cout << "База записана в " << baseline_path << "\n";
+    }
+    if (failures)
+        std::cout << failures << " случаев не прошли (допуск " << tolerance * 100 << "% и "
+                  << noise_floor * 1e3 << " мс)\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,17 @@
+/*
+ * hmm_qsort_preload.c
+ *
+ * Прослойка для LD_PRELOAD: подменяет qsort из libc на hmm_qsort, чтобы
+ * существующие программы использовали гибридную сортировку без пересборки.
+ *
+ * cmake --build build --target hmm_qsort   (собирается со скрытой видимостью,
+ *                                           наружу виден только qsort)
+ * LD_PRELOAD=./build/libhmm_qsort.so ./program
+ */
+
+#include "min_max_sort.h"
+
+__attribute__((visibility("default")))
+void qsort(void *base, size_t n, size_t size, int (*cmp)(const void *, const void *)) {
+    hmm_qsort(base, n, size, cmp);
+}
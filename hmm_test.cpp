@@ -0,0 +1,673 @@
+/*
+ * hmm_test.cpp
+ *
+ * Дифференциальный тест: каждая точка входа библиотеки сравнивается с
+ * std::sort на всех распределениях hmm_generate_pattern, на размерах от
+ * пустого массива до сотен тысяч элементов и нескольких зёрнах; для double
+ * и float – с NaN, -0 и бесконечностями. Отдельно проверяется, что
+ * PIVOT_KILLER не делает драйверы квадратичными. Код возврата 1, если хоть
+ * одна проверка не прошла.
+ */
+
+#include "min_max_sort.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* const kPatternNames[HMM_PATTERN_COUNT] = {
+    "random", "sorted", "reverse", "organ_pipe", "sawtooth",
+    "all_equal", "few_unique", "median3_killer", "pivot_killer"
+};
+
+const int kSizes[] = { 0, 1, 2, 3, 5, 16, 31, 64, 65, 100, 257, 1000, 4097, 65536, 300000 };
+const unsigned long long kSeeds[] = { 1, 0x9e3779b97f4a7c15ULL };
+
+// Генератор PIVOT_KILLER квадратичен – большие размеры для него пропускаются
+const int kKillerMaxSize = 65536;
+
+// Пределы времени: вход не медленнее slowdown времён эталонного входа того же
+// размера плюс kTimeFloorSeconds на шум. PIVOT_KILLER сравнивается с random –
+// квадратичное поведение при n = kKillerMaxSize медленнее в сотни раз. Вход
+// с 75% INT_MAX сравнивается с зеркальным (75% INT_MIN): оба конца диапазона
+// должны обрабатываться одинаково, без запасного слияния всего массива
+const double kKillerSlowdown = 8.0;
+const double kQsortVsStdSlowdown = 2.0;
+const double kMirrorSlowdown = 2.0;
+const int kHeavySize = 1 << 21;
+const double kTimeFloorSeconds = 0.02;
+const int kLazyPageSize = 1000;
+
+int g_checks = 0;
+int g_failures = 0;
+std::string g_case;
+
+void check(bool ok, const char* what) {
+    g_checks++;
+    if (!ok) {
+        g_failures++;
+        std::cerr << "FAIL " << what << " [" << g_case << "]\n";
+    }
+}
+
+int compare_int(const void* a, const void* b) {
+    int x = *static_cast<const int*>(a), y = *static_cast<const int*>(b);
+    return (x > y) - (x < y);
+}
+
+int compare_ll(const void* a, const void* b) {
+    long long x = *static_cast<const long long*>(a), y = *static_cast<const long long*>(b);
+    return (x > y) - (x < y);
+}
+
+// Сравнение long long по невыровненному адресу
+int compare_ll_unaligned(const void* a, const void* b) {
+    long long x, y;
+    std::memcpy(&x, a, sizeof(x));
+    std::memcpy(&y, b, sizeof(y));
+    return (x > y) - (x < y);
+}
+
+// Запись 12 байт: ключ и исходная позиция (для проверки перестановки)
+struct record {
+    int key;
+    int pos;
+    int pad;
+};
+
+int compare_record(const void* a, const void* b) {
+    return compare_int(&static_cast<const record*>(a)->key, &static_cast<const record*>(b)->key);
+}
+
+// 16-байтный элемент для специализированной копии hmm_qsort (выравнивание 16)
+struct alignas(16) wide16 {
+    long long hi;
+    long long lo;
+};
+
+bool operator<(const wide16& a, const wide16& b) {
+    return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo);
+}
+
+// Сравнения читают элементы через memcpy: годятся и для невыровненных массивов
+template <typename T>
+int compare_scalar(const void* a, const void* b) {
+    T x, y;
+    std::memcpy(&x, a, sizeof(T));
+    std::memcpy(&y, b, sizeof(T));
+    return (x > y) - (x < y);
+}
+
+int compare_wide16(const void* a, const void* b) {
+    wide16 x, y;
+    std::memcpy(&x, a, sizeof(x));
+    std::memcpy(&y, b, sizeof(y));
+    return (y < x) - (x < y);
+}
+
+// hmm_qsort на элементах типа T: выровненный массив идёт специализированной
+// копией QSORT_DEFINE, массив со смещением в один байт – обходным путём (для
+// одного байта оба – специализированной). Результат сравнивается с std::sort
+template <typename T>
+void check_qsort_elements(const std::vector<T>& input, hmm_cmp_fn cmp, const std::string& what) {
+    size_t n = input.size();
+    std::vector<T> expected = input;
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<T> a = input;
+    hmm_qsort(a.data(), n, sizeof(T), cmp);
+    check(n == 0 || std::memcmp(a.data(), expected.data(), n * sizeof(T)) == 0, what.c_str());
+
+    std::vector<char> bytes(n * sizeof(T) + 1);
+    if (n > 0)
+        std::memcpy(bytes.data() + 1, input.data(), n * sizeof(T));
+    hmm_qsort(bytes.data() + 1, n, sizeof(T), cmp);
+    check(n == 0 || std::memcmp(bytes.data() + 1, expected.data(), n * sizeof(T)) == 0,
+          (what + " unaligned").c_str());
+}
+
+// Порядок hybrid_min_max_sort_total_*: числа по значению, -0 перед +0,
+// затем +NaN, затем -NaN
+template <typename T>
+bool total_less(T a, T b) {
+    int ra = std::isnan(a) ? (std::signbit(a) ? 2 : 1) : 0;
+    int rb = std::isnan(b) ? (std::signbit(b) ? 2 : 1) : 0;
+    if (ra != rb)
+        return ra < rb;
+    if (ra != 0)
+        return false;
+    return a < b || (a == b && std::signbit(a) && !std::signbit(b));
+}
+
+template <typename T>
+bool same_bits(const std::vector<T>& a, const std::vector<T>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0);
+}
+
+/* ==================== int ==================== */
+
+// Источник серий для hmm_kmerge_stream: отдаёт массив кусками по chunk
+struct array_reader {
+    const int* data;
+    int len, pos, chunk;
+};
+
+int array_read(void* ctx, int* buf, int cap) {
+    array_reader* r = static_cast<array_reader*>(ctx);
+    int count = std::min(std::min(cap, r->chunk), r->len - r->pos);
+    std::memcpy(buf, r->data + r->pos, count * sizeof(int));
+    r->pos += count;
+    return count;
+}
+
+int vector_write(void* ctx, const int* buf, int n) {
+    std::vector<int>* out = static_cast<std::vector<int>*>(ctx);
+    out->insert(out->end(), buf, buf + n);
+    return 0;
+}
+
+void test_int_sorts(const std::vector<int>& input, const std::vector<int>& expected) {
+    int n = static_cast<int>(input.size());
+    std::vector<int> a;
+
+    a = input;
+    if (n > 0)
+        hybrid_min_max_sort_serial(a.data(), 0, n - 1, 2);
+    check(a == expected, "hybrid_min_max_sort_serial");
+
+    a = input;
+    if (n > 0)
+        hybrid_min_max_sort_seeded(a.data(), 0, n - 1, 12345);
+    check(a == expected, "hybrid_min_max_sort_seeded");
+
+    std::vector<int> dst(n);
+    hybrid_min_max_sort_copy(input.data(), dst.data(), n);
+    check(dst == expected, "hybrid_min_max_sort_copy");
+
+    a = input;
+    hybrid_min_max_sort_large(a.data(), n);
+    check(a == expected, "hybrid_min_max_sort_large");
+
+    a = input;
+    hybrid_min_max_sort_numa(a.data(), n, 4, nullptr);
+    check(a == expected, "hybrid_min_max_sort_numa");
+
+    // Топология без узлов заменяется определённой автоматически
+    a = input;
+    hmm_numa_topology empty_topo = {};
+    hybrid_min_max_sort_numa(a.data(), n, 4, &empty_topo);
+    check(a == expected, "hybrid_min_max_sort_numa empty topology");
+
+    a = input;
+    if (n > 0)
+        hmm_merge_sort(a.data(), 0, n - 1);
+    check(a == expected, "hmm_merge_sort");
+
+    a = input;
+    hmm_merge_sort_large(a.data(), n);
+    check(a == expected, "hmm_merge_sort_large");
+
+    a = input;
+    hmm_qsort(a.data(), n, sizeof(int), compare_int);
+    check(a == expected, "hmm_qsort int");
+
+    std::vector<long long> wide(input.begin(), input.end()), wide_expected(expected.begin(), expected.end());
+    hmm_qsort(wide.data(), n, sizeof(long long), compare_ll);
+    check(wide == wide_expected, "hmm_qsort long long");
+
+    // Массив со смещением в один байт: специализированный путь не годится
+    std::vector<long long> unsorted(input.begin(), input.end());
+    std::vector<char> bytes(n * sizeof(long long) + 1);
+    if (n > 0)
+        std::memcpy(bytes.data() + 1, unsorted.data(), n * sizeof(long long));
+    hmm_qsort(bytes.data() + 1, n, sizeof(long long), compare_ll_unaligned);
+    check(n == 0 || std::memcmp(bytes.data() + 1, wide_expected.data(), n * sizeof(long long)) == 0,
+          "hmm_qsort unaligned");
+
+    std::vector<record> recs(n);
+    for (int i = 0; i < n; i++)
+        recs[i] = record{ input[i], i, 0 };
+    hmm_qsort(recs.data(), n, sizeof(record), compare_record);
+    bool recs_ok = true;
+    std::vector<char> seen(n, 0);
+    for (int i = 0; i < n && recs_ok; i++) {
+        recs_ok = recs[i].key == expected[i] && recs[i].pos >= 0 && recs[i].pos < n &&
+                  !seen[recs[i].pos] && input[recs[i].pos] == recs[i].key;
+        if (recs_ok)
+            seen[recs[i].pos] = 1;
+    }
+    check(recs_ok, "hmm_qsort record");
+
+    // Размеры 1, 2 и 16 байт: свои копии QSORT_DEFINE
+    std::vector<unsigned char> u8(n);
+    std::vector<short> i16(n);
+    std::vector<wide16> w16(n);
+    for (int i = 0; i < n; i++) {
+        u8[i] = static_cast<unsigned char>(input[i]);
+        i16[i] = static_cast<short>(input[i]);
+        w16[i] = wide16{ input[i] / 1000, input[i] % 1000 };
+    }
+    check_qsort_elements(u8, compare_scalar<unsigned char>, "hmm_qsort unsigned char");
+    check_qsort_elements(i16, compare_scalar<short>, "hmm_qsort short");
+    check_qsort_elements(w16, compare_wide16, "hmm_qsort 16-byte");
+
+    a = input;
+    hmm::sort(a);
+    check(a == expected, "hmm::sort int");
+
+    a = input;
+    if (n > 0)
+        hmm::hybrid_min_max_sort(a, 0, n - 1, 2);
+    check(a == expected, "hmm::hybrid_min_max_sort");
+
+    a = input;
+    int half = n / 2;
+    std::sort(a.begin(), a.begin() + half);
+    hmm_append_sorted(a.data(), half, n);
+    check(a == expected, "hmm_append_sorted");
+}
+
+void test_int_incremental(const std::vector<int>& input, const std::vector<int>& expected) {
+    int n = static_cast<int>(input.size());
+    std::vector<int> a = input;
+
+    hmm_sort_task task;
+    hmm_sort_task_init(&task, a.data(), n);
+    int steps = 0;
+    while (!hmm_sort_task_step(&task, 20000) && steps < 100000000)
+        steps++;
+    check(a == expected && hmm_sort_task_progress(&task) == 1.0, "hmm_sort_task");
+
+    // Ленивый итератор: несколько элементов по одному, затем страницами
+    a = input;
+    hmm_lazy_iter it;
+    hmm_lazy_iter_init(&it, a.data(), n);
+    std::vector<int> got;
+    int v;
+    while (got.size() < 3 && hmm_lazy_iter_next(&it, &v))
+        got.push_back(v);
+    const int* page;
+    int len;
+    while ((len = hmm_lazy_iter_page(&it, 777, &page)) > 0)
+        got.insert(got.end(), page, page + len);
+    check(got == expected, "hmm_lazy_iter");
+}
+
+void test_int_unique(const std::vector<int>& input, const std::vector<int>& expected) {
+    int n = static_cast<int>(input.size());
+    std::vector<int> keys, counts;
+    for (int i = 0; i < n;) {
+        int j = i;
+        while (j < n && expected[j] == expected[i])
+            j++;
+        keys.push_back(expected[i]);
+        counts.push_back(j - i);
+        i = j;
+    }
+
+    std::vector<int> a = input;
+    int distinct = hybrid_min_max_sort_unique(a.data(), n);
+    a.resize(distinct);
+    check(a == keys, "hybrid_min_max_sort_unique");
+
+    a = input;
+    std::vector<int> keys_out(n), counts_out(n);
+    distinct = hybrid_min_max_sort_count(a.data(), n, keys_out.data(), counts_out.data());
+    keys_out.resize(distinct);
+    counts_out.resize(distinct);
+    check(keys_out == keys && counts_out == counts, "hybrid_min_max_sort_count");
+
+    a = input;
+    hmm::sort_unique(a);
+    check(a == keys, "hmm::sort_unique");
+}
+
+// Корзины должны идти по возрастанию значений (с разделителями – попадать в
+// свои диапазоны) и вместе содержать исходные элементы
+void check_buckets(const std::vector<int>& a, const std::vector<int>& offsets, const int splitters[],
+                   const std::vector<int>& expected, const char* what) {
+    int bucket_count = static_cast<int>(offsets.size()) - 1;
+    int n = static_cast<int>(a.size());
+    bool ok = offsets[0] == 0 && offsets[bucket_count] == n;
+    long long prev_max = std::numeric_limits<long long>::min();
+    for (int b = 0; ok && b < bucket_count; b++) {
+        ok = offsets[b] <= offsets[b + 1];
+        if (!ok || offsets[b] == offsets[b + 1])
+            continue;
+        int lo = *std::min_element(a.begin() + offsets[b], a.begin() + offsets[b + 1]);
+        int hi = *std::max_element(a.begin() + offsets[b], a.begin() + offsets[b + 1]);
+        ok = lo > prev_max;
+        if (splitters)
+            ok = ok && (b == 0 || lo >= splitters[b - 1]) && (b == bucket_count - 1 || hi < splitters[b]);
+        prev_max = hi;
+    }
+    std::vector<int> sorted = a;
+    std::sort(sorted.begin(), sorted.end());
+    check(ok && sorted == expected, what);
+}
+
+void test_int_partition(const std::vector<int>& input, const std::vector<int>& expected) {
+    int n = static_cast<int>(input.size());
+    std::vector<int> a = input;
+    std::vector<int> offsets(9);
+    hybrid_min_max_partition(a.data(), n, nullptr, 8, offsets.data(), 1);
+    check_buckets(a, offsets, nullptr, expected, "hybrid_min_max_partition sampled");
+
+    a = input;
+    hybrid_min_max_partition(a.data(), n, nullptr, 8, offsets.data(), 4);
+    check_buckets(a, offsets, nullptr, expected, "hybrid_min_max_partition parallel");
+
+    if (n > 0) {
+        int splitters[2] = { expected[n / 3], expected[(2 * n) / 3] };
+        a = input;
+        offsets.assign(4, 0);
+        hybrid_min_max_partition(a.data(), n, splitters, 3, offsets.data(), 1);
+        check_buckets(a, offsets, splitters, expected, "hybrid_min_max_partition three buckets");
+    }
+}
+
+void test_int_kmerge(const std::vector<int>& input, const std::vector<int>& expected) {
+    int n = static_cast<int>(input.size());
+    const int k = 7;
+    std::vector<int> sorted_runs = input;
+    const int* runs[k];
+    int lens[k];
+    for (int r = 0; r < k; r++) {
+        int lo = static_cast<int>(static_cast<long long>(n) * r / k);
+        int hi = static_cast<int>(static_cast<long long>(n) * (r + 1) / k);
+        std::sort(sorted_runs.begin() + lo, sorted_runs.begin() + hi);
+        runs[r] = sorted_runs.data() + lo;
+        lens[r] = hi - lo;
+    }
+
+    std::vector<int> out(n);
+    hmm_kmerge(runs, lens, k, out.data());
+    check(out == expected, "hmm_kmerge");
+
+    std::fill(out.begin(), out.end(), 0);
+    hmm_kmerge_parallel(runs, lens, k, out.data(), 3);
+    check(out == expected, "hmm_kmerge_parallel");
+
+    std::fill(out.begin(), out.end(), 0);
+    hmm_kmerge_generic(reinterpret_cast<const void**>(runs), lens, k, sizeof(int), compare_int, out.data());
+    check(out == expected, "hmm_kmerge_generic");
+
+    array_reader readers_ctx[k];
+    hmm_run_reader readers[k];
+    for (int r = 0; r < k; r++) {
+        readers_ctx[r] = array_reader{ runs[r], lens[r], 0, 100 + 37 * r };
+        readers[r] = hmm_run_reader{ &readers_ctx[r], array_read };
+    }
+    std::vector<int> streamed;
+    long long written = hmm_kmerge_stream(readers, k, vector_write, &streamed);
+    check(written == n && streamed == expected, "hmm_kmerge_stream");
+}
+
+void test_int_dist(const std::vector<int>& input, const std::vector<int>& expected) {
+    std::vector<int> a = input;
+    int rc = hmm_dist_sort_local(a.data(), static_cast<int>(a.size()), 3);
+    check(rc == 0 && a == expected, "hmm_dist_sort_local");
+}
+
+/* ==================== double и float ==================== */
+
+template <typename T>
+std::vector<T> floating_from(const std::vector<int>& input) {
+    std::vector<T> out(input.size());
+    for (size_t i = 0; i < input.size(); i++)
+        out[i] = static_cast<T>(input[i]) * static_cast<T>(0.5) - static_cast<T>(3);
+    return out;
+}
+
+// Особые значения на каждой 61-й позиции: NaN обоих знаков, нули, бесконечности
+template <typename T>
+void inject_specials(std::vector<T>& v) {
+    const T specials[] = {
+        std::numeric_limits<T>::quiet_NaN(), -std::numeric_limits<T>::quiet_NaN(),
+        static_cast<T>(0), -static_cast<T>(0),
+        std::numeric_limits<T>::infinity(), -std::numeric_limits<T>::infinity(),
+        std::numeric_limits<T>::denorm_min(), -std::numeric_limits<T>::max()
+    };
+    const int count = sizeof(specials) / sizeof(specials[0]);
+    for (size_t i = 0, s = 0; i < v.size(); i += 61, s++)
+        v[i] = specials[s % count];
+}
+
+void test_double(const std::vector<int>& input) {
+    int n = static_cast<int>(input.size());
+    std::vector<double> src = floating_from<double>(input);
+    std::vector<double> expected = src;
+    std::sort(expected.begin(), expected.end());
+
+    std::vector<double> a = src;
+    if (n > 0)
+        hybrid_min_max_sort_serial_double(a.data(), 0, n - 1, 2);
+    check(a == expected, "hybrid_min_max_sort_serial_double");
+
+    a = src;
+    hmm::sort(a);
+    check(a == expected, "hmm::sort double");
+
+    a = src;
+    int half = n / 2;
+    std::sort(a.begin(), a.begin() + half);
+    hmm_append_sorted_double(a.data(), half, n);
+    check(a == expected, "hmm_append_sorted_double");
+
+    inject_specials(src);
+    expected = src;
+    std::sort(expected.begin(), expected.end(), total_less<double>);
+    a = src;
+    hybrid_min_max_sort_total_double(a.data(), n);
+    check(same_bits(a, expected), "hybrid_min_max_sort_total_double");
+}
+
+void test_float(const std::vector<int>& input) {
+    std::vector<float> src = floating_from<float>(input);
+    inject_specials(src);
+    std::vector<float> expected = src;
+    std::sort(expected.begin(), expected.end(), total_less<float>);
+    std::vector<float> a = src;
+    hmm::sort_total(a);
+    check(same_bits(a, expected), "hybrid_min_max_sort_total_float");
+}
+
+/* ==================== Столбцы ==================== */
+
+void test_columns(const std::vector<int>& input) {
+    int n = static_cast<int>(input.size());
+    std::vector<int64_t> c0(n);
+    std::vector<double> c1(n);
+    std::vector<int> c2(n), rank(16);
+    for (int i = 0; i < n; i++) {
+        c0[i] = static_cast<int64_t>(input[i] % 5) * 1000000007LL;
+        c1[i] = (input[i] % 3) * -0.25;
+        c2[i] = (input[i] / 7) & 15;
+    }
+    for (int code = 0; code < 16; code++)
+        rank[code] = (code * 7) % 16;   // словарь с порядком, отличным от кодов
+
+    hmm_column cols[3] = {
+        { HMM_COLUMN_INT64, c0.data(), nullptr, 0 },
+        { HMM_COLUMN_DOUBLE, c1.data(), nullptr, 1 },
+        { HMM_COLUMN_DICT, c2.data(), rank.data(), 0 }
+    };
+    std::vector<int> perm(n), expected(n);
+    hmm_sort_columns(cols, 3, n, perm.data());
+    for (int i = 0; i < n; i++)
+        expected[i] = i;
+    std::stable_sort(expected.begin(), expected.end(), [&](int x, int y) {
+        if (c0[x] != c0[y])
+            return c0[x] < c0[y];
+        if (c1[x] != c1[y])
+            return c1[x] > c1[y];
+        return rank[c2[x]] < rank[c2[y]];
+    });
+    check(perm == expected, "hmm_sort_columns");
+}
+
+// Лучшее из трёх время sort на копиях input, секунды
+template <typename Sort>
+double best_time(const std::vector<int>& input, Sort sort) {
+    double best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        std::vector<int> a = input;
+        auto start = std::chrono::steady_clock::now();
+        sort(a);
+        std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+        best = std::min(best, t.count());
+    }
+    return best;
+}
+
+// Время t не больше limit (секунды)
+void check_time(const char* what, double t, double limit) {
+    check(t <= limit, what);
+    if (t > limit)
+        std::cerr << "  " << t * 1e3 << " мс, предел " << limit * 1e3 << " мс\n";
+}
+
+// Время sort на input не больше slowdown времён на reference плюс kTimeFloorSeconds
+template <typename Sort>
+void check_time_bound(const char* what, const std::vector<int>& reference,
+                      const std::vector<int>& input, double slowdown, Sort sort) {
+    double limit = slowdown * best_time(reference, sort) + kTimeFloorSeconds;
+    check_time(what, best_time(input, sort), limit);
+}
+
+// Предел глубины разбиений: PIVOT_KILLER не должен делать драйверы квадратичными
+void test_killer_bound() {
+    const int n = kKillerMaxSize;
+    std::vector<int> killer(n), random(n);
+    hmm_generate_pattern(killer.data(), n, HMM_PATTERN_PIVOT_KILLER, 1);
+    hmm_generate_pattern(random.data(), n, HMM_PATTERN_RANDOM, 1);
+    g_case = "pivot_killer bound n=" + std::to_string(n);
+    auto bounded = [&](const char* what, auto sort) {
+        check_time_bound(what, random, killer, kKillerSlowdown, sort);
+    };
+    bounded("killer bound hybrid_min_max_sort_serial", [](std::vector<int>& a) {
+        hybrid_min_max_sort_serial(a.data(), 0, n - 1, 2);
+    });
+    bounded("killer bound hybrid_min_max_sort_large", [](std::vector<int>& a) {
+        hybrid_min_max_sort_large(a.data(), n);
+    });
+    bounded("killer bound hmm_sort_task", [](std::vector<int>& a) {
+        hmm_sort_task task;
+        hmm_sort_task_init(&task, a.data(), n);
+        while (!hmm_sort_task_step(&task, 1000000000LL)) {
+        }
+    });
+    bounded("killer bound hmm::hybrid_min_max_sort", [](std::vector<int>& a) {
+        hmm::hybrid_min_max_sort(a, 0, n - 1, 2);
+    });
+}
+
+// hmm_qsort на двух значениях: сегмент, целиком лежащий между опорными,
+// делится по равенству опорным, а не уходит в пирамидальную сортировку.
+// Нижняя половина – в основном нули, верхняя – единицы, так что опорные
+// гарантированно разные. Замена qsort не должна проигрывать std::sort больше
+// чем в kQsortVsStdSlowdown раз
+void test_qsort_few_unique_bound() {
+    const int n = kHeavySize;
+    std::vector<int> two_valued(n);
+    hmm_generate_pattern(two_valued.data(), n, HMM_PATTERN_RANDOM, 1);
+    for (int i = 0; i < n; i++)
+        two_valued[i] = (i >= n / 2) ^ (two_valued[i] % 4 == 0);
+    g_case = "hmm_qsort two-valued bound n=" + std::to_string(n);
+    auto sort = [](std::vector<int>& a) {
+        hmm_qsort(a.data(), a.size(), sizeof(int), compare_int);
+    };
+    std::vector<int> a = two_valued, expected = two_valued;
+    sort(a);
+    std::sort(expected.begin(), expected.end());
+    check(a == expected, "hmm_qsort two-valued");
+    double std_seconds = best_time(two_valued, [](std::vector<int>& v) { std::sort(v.begin(), v.end()); });
+    check_time("hmm_qsort two-valued bound", best_time(two_valued, sort),
+               kQsortVsStdSlowdown * std_seconds + kTimeFloorSeconds);
+}
+
+// 75% элементов равны extreme, остальные случайны (позиции одинаковы для
+// INT_MAX и INT_MIN, так что входы зеркальны)
+std::vector<int> extreme_heavy(int n, int extreme) {
+    std::vector<int> a(n);
+    hmm_generate_pattern(a.data(), n, HMM_PATTERN_RANDOM, 1);
+    for (int i = 0; i < n; i++)
+        if (static_cast<unsigned>(a[i]) % 4 != 0)
+            a[i] = extreme;
+    return a;
+}
+
+// Сдвиг опорных с границ значений симметричен: серия INT_MAX отщепляется так же
+// дёшево, как серия INT_MIN
+void test_extreme_heavy_bound() {
+    const int n = kHeavySize;
+    std::vector<int> max_heavy = extreme_heavy(n, std::numeric_limits<int>::max());
+    std::vector<int> min_heavy = extreme_heavy(n, std::numeric_limits<int>::min());
+    g_case = "max-heavy bound n=" + std::to_string(n);
+    auto bounded = [&](const char* what, auto sort) {
+        check_time_bound(what, min_heavy, max_heavy, kMirrorSlowdown, sort);
+    };
+    bounded("max-heavy bound hybrid_min_max_sort_serial", [](std::vector<int>& a) {
+        hybrid_min_max_sort_serial(a.data(), 0, n - 1, 2);
+    });
+    bounded("max-heavy bound hybrid_min_max_sort_large", [](std::vector<int>& a) {
+        hybrid_min_max_sort_large(a.data(), n);
+    });
+    bounded("max-heavy bound hmm_sort_task", [](std::vector<int>& a) {
+        hmm_sort_task task;
+        hmm_sort_task_init(&task, a.data(), n);
+        while (!hmm_sort_task_step(&task, 1000000000LL)) {
+        }
+    });
+    // Первая страница ленивого итератора стоит O(n + m log m), а не полной сортировки
+    bounded("max-heavy bound hmm_lazy_iter first page", [](std::vector<int>& a) {
+        hmm_lazy_iter it;
+        const int* page;
+        hmm_lazy_iter_init(&it, a.data(), n);
+        hmm_lazy_iter_page(&it, kLazyPageSize, &page);
+    });
+}
+
+} // namespace
+
+int main() {
+    for (int kind = 0; kind < HMM_PATTERN_COUNT; kind++) {
+        for (int n : kSizes) {
+            if (kind == HMM_PATTERN_PIVOT_KILLER && n > kKillerMaxSize)
+                continue;
+            for (unsigned long long seed : kSeeds) {
+                g_case = std::string(kPatternNames[kind]) + " n=" + std::to_string(n) +
+                         " seed=" + std::to_string(seed);
+                std::vector<int> input(n);
+                if (n > 0)
+                    hmm_generate_pattern(input.data(), n, kind, seed);
+                std::vector<int> expected = input;
+                std::sort(expected.begin(), expected.end());
+
+                test_int_sorts(input, expected);
+                test_int_incremental(input, expected);
+                test_int_unique(input, expected);
+                test_int_partition(input, expected);
+                test_int_kmerge(input, expected);
+                if (n <= 65536 && seed == kSeeds[0])
+                    test_int_dist(input, expected);
+                test_double(input);
+                test_float(input);
+                test_columns(input);
+            }
+        }
+    }
+    test_killer_bound();
+    test_extreme_heavy_bound();
+    test_qsort_few_unique_bound();
+    std::cout << g_checks - g_failures << "/" << g_checks << " проверок пройдено\n";
+    return g_failures == 0 ? 0 : 1;
+}
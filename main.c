@@ -2,14 +2,192 @@
  * main.c
  *
  * Пример использования гибридной сортировки Min-Max для int и double.
+ * С ключом --calibrate подбирает пороги под текущую машину,
+ * с ключом --dist-bench измеряет масштабирование распределённой сортировки,
+ * с ключом --bandwidth сравнивает пропускную способность обычного и большого режимов,
+ * с ключом --patterns замеряет время на тяжёлых распределениях, включая противника,
+ * с ключом --trace записывает временную шкалу сортировки (сборка с -DHMM_TRACE).
  */
 
 #include "min_max_sort.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
-int main(void) {
+// Режим калибровки: ./min_max_sort --calibrate [профиль] [заголовок]
+static int run_calibration(int argc, char *argv[]) {
+    const char *profile = (argc > 2) ? argv[2] : "hmm_tuning.txt";
+    hmm_tuning_calibrate(1);
+    if (hmm_tuning_save(profile) != 0) {
+        fprintf(stderr, "Не удалось записать профиль %s.\n", profile);
+        return EXIT_FAILURE;
+    }
+    printf("Профиль записан в %s\n", profile);
+    if (argc > 3) {
+        if (hmm_tuning_write_header(argv[3]) != 0) {
+            fprintf(stderr, "Не удалось записать заголовок %s.\n", argv[3]);
+            return EXIT_FAILURE;
+        }
+        printf("Заголовок записан в %s\n", argv[3]);
+    }
+    return 0;
+}
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Масштабирование распределённой сортировки: ./min_max_sort --dist-bench [n]
+static int run_dist_bench(int argc, char *argv[]) {
+    int n = (argc > 2) ? atoi(argv[2]) : 10000000;
+    int *src = malloc(n * sizeof(int));
+    int *arr = malloc(n * sizeof(int));
+    if (!src || !arr) {
+        fprintf(stderr, "Ошибка выделения памяти.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < n; i++)
+        src[i] = rand();
+    double base = 0;
+    printf("Распределённая сортировка, %d элементов\n", n);
+    for (int ranks = 1; ranks <= 16; ranks *= 2) {
+        memcpy(arr, src, n * sizeof(int));
+        double start = wall_seconds();
+        int rc = hmm_dist_sort_local(arr, n, ranks);
+        double t = wall_seconds() - start;
+        int sorted = rc == 0;
+        for (int i = 1; sorted && i < n; i++)
+            sorted = arr[i - 1] <= arr[i];
+        if (ranks == 1)
+            base = t;
+        printf("Рангов: %2d, время: %.6f сек, ускорение: %.2f, отсортировано: %s\n",
+               ranks, t, base / t, sorted ? "ДА" : "НЕТ");
+    }
+    free(arr);
+    free(src);
+    return 0;
+}
+
+// Пропускная способность (ГБ/с по объёму сортируемых данных) обычного и
+// большого режимов: ./min_max_sort --bandwidth [n]
+static int run_bandwidth_bench(int argc, char *argv[]) {
+    int n = (argc > 2) ? atoi(argv[2]) : 100000000;
+    int *src = malloc(n * sizeof(int));
+    int *arr = malloc(n * sizeof(int));
+    if (!src || !arr) {
+        fprintf(stderr, "Ошибка выделения памяти.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < n; i++)
+        src[i] = rand();
+    double gb = (double)n * sizeof(int) / 1e9;
+    printf("Пропускная способность, %d элементов (%.2f ГБ)\n", n, gb);
+    for (int mode = 0; mode < 4; mode++) {
+        static const char *names[] = {
+            "hybrid_min_max_sort_serial", "hybrid_min_max_sort_large", "hmm_merge_sort", "hmm_merge_sort_large"
+        };
+        memcpy(arr, src, n * sizeof(int));
+        double start = wall_seconds();
+        if (mode == 0)
+            hybrid_min_max_sort_serial(arr, 0, n - 1, 2);
+        else if (mode == 1)
+            hybrid_min_max_sort_large(arr, n);
+        else if (mode == 2)
+            hmm_merge_sort(arr, 0, n - 1);
+        else
+            hmm_merge_sort_large(arr, n);
+        double t = wall_seconds() - start;
+        int sorted = 1;
+        for (int i = 1; sorted && i < n; i++)
+            sorted = arr[i - 1] <= arr[i];
+        printf("%-28s %.6f сек, %.3f ГБ/с, отсортировано: %s\n", names[mode], t, gb / t, sorted ? "ДА" : "НЕТ");
+    }
+    free(arr);
+    free(src);
+    return 0;
+}
+
+// Время фиксированной и случайной выборки опорных на всех распределениях
+// hmm_generate_pattern: ./min_max_sort --patterns [n] [seed]
+static int run_pattern_bench(int argc, char *argv[]) {
+    static const char *names[HMM_PATTERN_COUNT] = {
+        "random", "sorted", "reverse", "organ_pipe", "sawtooth",
+        "all_equal", "few_unique", "median3_killer", "pivot_killer"
+    };
+    int n = (argc > 2) ? atoi(argv[2]) : 100000;
+    unsigned long long seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+    int *src = malloc(n * sizeof(int));
+    int *arr = malloc(n * sizeof(int));
+    if (!src || !arr) {
+        fprintf(stderr, "Ошибка выделения памяти.\n");
+        return EXIT_FAILURE;
+    }
+    printf("%-16s %14s %14s  (%d элементов)\n", "распределение", "serial, сек", "seeded, сек", n);
+    for (int kind = 0; kind < HMM_PATTERN_COUNT; kind++) {
+        double t[2];
+        int sorted = 1;
+        hmm_generate_pattern(src, n, kind, seed);
+        for (int mode = 0; mode < 2; mode++) {
+            memcpy(arr, src, n * sizeof(int));
+            double start = wall_seconds();
+            if (mode == 0)
+                hybrid_min_max_sort_serial(arr, 0, n - 1, 2);
+            else
+                hybrid_min_max_sort_seeded(arr, 0, n - 1, seed);
+            t[mode] = wall_seconds() - start;
+            for (int i = 1; sorted && i < n; i++)
+                sorted = arr[i - 1] <= arr[i];
+        }
+        printf("%-16s %14.6f %14.6f  %s\n", names[kind], t[0], t[1], sorted ? "ДА" : "НЕТ");
+    }
+    free(arr);
+    free(src);
+    return 0;
+}
+
+// Трасса параллельной сортировки для chrome://tracing или Perfetto:
+// ./min_max_sort --trace [n] [потоков] [файл]
+static int run_trace(int argc, char *argv[]) {
+    int n = (argc > 2) ? atoi(argv[2]) : 10000000;
+    int threads = (argc > 3) ? atoi(argv[3]) : 4;
+    const char *path = (argc > 4) ? argv[4] : "hmm_trace.json";
+#ifndef HMM_TRACE
+    fprintf(stderr, "Сборка без -DHMM_TRACE: трасса будет пустой.\n");
+#endif
+    int *arr = malloc(n * sizeof(int));
+    if (!arr) {
+        fprintf(stderr, "Ошибка выделения памяти.\n");
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < n; i++)
+        arr[i] = rand();
+    hmm_numa_topology topo;
+    hmm_numa_detect(&topo);
+    hybrid_min_max_sort_numa(arr, n, threads, &topo);
+    free(arr);
+    if (hmm_trace_dump(path) != 0) {
+        fprintf(stderr, "Не удалось записать трассу %s.\n", path);
+        return EXIT_FAILURE;
+    }
+    printf("Трасса записана в %s\n", path);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--calibrate") == 0)
+        return run_calibration(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--dist-bench") == 0)
+        return run_dist_bench(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--bandwidth") == 0)
+        return run_bandwidth_bench(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--patterns") == 0)
+        return run_pattern_bench(argc, argv);
+    if (argc > 1 && strcmp(argv[1], "--trace") == 0)
+        return run_trace(argc, argv);
+
     srand((unsigned)time(NULL));
 
     /* --- Тест для int --- */
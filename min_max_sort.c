@@ -7,9 +7,43 @@
 #include "min_max_sort.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
 
-#define THRESHOLD_DEFAULT 64
+#ifdef HMM_USE_TUNED_HEADER
+#include "hmm_tuned.h"
+#endif
+
+// Значения по умолчанию; сгенерированный калибровкой hmm_tuned.h их переопределяет
+#ifndef HMM_TUNED_INT_INSERTION_THRESHOLD
+#define HMM_TUNED_INT_INSERTION_THRESHOLD 64
+#endif
+#ifndef HMM_TUNED_INT_MEDIAN5_THRESHOLD
+#define HMM_TUNED_INT_MEDIAN5_THRESHOLD 128
+#endif
+#ifndef HMM_TUNED_DOUBLE_INSERTION_THRESHOLD
+#define HMM_TUNED_DOUBLE_INSERTION_THRESHOLD 64
+#endif
+#ifndef HMM_TUNED_DOUBLE_MEDIAN5_THRESHOLD
+#define HMM_TUNED_DOUBLE_MEDIAN5_THRESHOLD 128
+#endif
+#ifndef HMM_TUNED_QSORT_INSERTION_THRESHOLD
+#define HMM_TUNED_QSORT_INSERTION_THRESHOLD 16
+#endif
+#ifndef HMM_TUNED_QSORT_MEDIAN5_THRESHOLD
+#define HMM_TUNED_QSORT_MEDIAN5_THRESHOLD 128
+#endif
+
+// Ёмкость явного стека драйвера: при откладывании двух больших частей глубина
+// не превышает 2 * log3(2^31) + 2 записей
+#define SORT_STACK_SIZE 64
+
+// Текущий профиль настройки (загружается hmm_tuning_load или калибровкой)
+hmm_tuning hmm_tuning_profile = {
+    { HMM_TUNED_INT_INSERTION_THRESHOLD, HMM_TUNED_INT_MEDIAN5_THRESHOLD },
+    { HMM_TUNED_DOUBLE_INSERTION_THRESHOLD, HMM_TUNED_DOUBLE_MEDIAN5_THRESHOLD },
+    { HMM_TUNED_QSORT_INSERTION_THRESHOLD, HMM_TUNED_QSORT_MEDIAN5_THRESHOLD },
+};
 
 /* ==================== Вспомогательные функции ==================== */
 
@@ -30,7 +64,7 @@ static inline void swap_double(double *a, double *b) {
 /* ==================== Функции сортировки для int ==================== */
 
 // Сортировка вставками для int
-void insertion_sort(int arr[], int low, int high) {
+void hmm_insertion_sort(int arr[], int low, int high) {
     for (int i = low + 1; i <= high; i++) {
         int key = arr[i];
         int j = i - 1;
@@ -42,13 +76,14 @@ void insertion_sort(int arr[], int low, int high) {
     }
 }
 
-// Адаптивный порог (если размер сегмента меньше THRESHOLD_DEFAULT, то используем его, иначе – THRESHOLD_DEFAULT)
-int get_adaptive_threshold(int segment_size) {
-    return (segment_size < THRESHOLD_DEFAULT) ? segment_size : THRESHOLD_DEFAULT;
+// Адаптивный порог (если размер сегмента меньше порога профиля, то используем его, иначе – порог профиля)
+int hmm_get_adaptive_threshold(int segment_size) {
+    int threshold = hmm_tuning_profile.int_params.insertion_threshold;
+    return (segment_size < threshold) ? segment_size : threshold;
 }
 
 // Медиана из 5 элементов (возвращает индекс)
-int median_of_five_index(const int arr[], int i1, int i2, int i3, int i4, int i5) {
+int hmm_median_of_five_index(const int arr[], int i1, int i2, int i3, int i4, int i5) {
     int indices[5] = { i1, i2, i3, i4, i5 };
     for (int i = 1; i < 5; i++) {
         int temp = indices[i];
@@ -63,7 +98,7 @@ int median_of_five_index(const int arr[], int i1, int i2, int i3, int i4, int i5
 }
 
 // Медиана из 3 элементов (возвращает индекс)
-int median_of_three_index(const int arr[], int i1, int i2, int i3) {
+int hmm_median_of_three_index(const int arr[], int i1, int i2, int i3) {
     if (arr[i1] < arr[i2]) {
         if (arr[i2] < arr[i3])
             return i2;
@@ -82,32 +117,32 @@ int median_of_three_index(const int arr[], int i1, int i2, int i3) {
 }
 
 // Выбор нижнего опорного элемента (для левого сегмента)
-int select_lower_pivot(const int arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
-        return median_of_three_index(arr, left, left + segment_size / 4, left + segment_size / 2);
+int hmm_select_lower_pivot(const int arr[], int left, int right, int segment_size) {
+    if (segment_size < hmm_tuning_profile.int_params.median5_threshold) {
+        return hmm_median_of_three_index(arr, left, left + segment_size / 4, left + segment_size / 2);
     } else {
-        return median_of_five_index(arr, left, left + segment_size / 8, left + segment_size / 4,
+        return hmm_median_of_five_index(arr, left, left + segment_size / 8, left + segment_size / 4,
                                      left + (3 * segment_size) / 8, left + segment_size / 2);
     }
 }
 
 // Выбор верхнего опорного элемента (для правого сегмента)
-int select_upper_pivot(const int arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
-        return median_of_three_index(arr, left + segment_size / 2, left + (3 * segment_size) / 4, right);
+int hmm_select_upper_pivot(const int arr[], int left, int right, int segment_size) {
+    if (segment_size < hmm_tuning_profile.int_params.median5_threshold) {
+        return hmm_median_of_three_index(arr, left + segment_size / 2, left + (3 * segment_size) / 4, right);
     } else {
-        return median_of_five_index(arr, left + segment_size / 2, left + (5 * segment_size) / 8,
+        return hmm_median_of_five_index(arr, left + segment_size / 2, left + (5 * segment_size) / 8,
                                      left + (3 * segment_size) / 4, left + (7 * segment_size) / 8, right);
     }
 }
 
 // Классическое слияние двух отсортированных частей массива
-void merge(int arr[], int left, int mid, int right) {
+void hmm_merge(int arr[], int left, int mid, int right) {
     int n1 = mid - left + 1, n2 = right - mid;
     int *L = malloc(n1 * sizeof(int));
     int *R = malloc(n2 * sizeof(int));
     if (!L || !R) {
-        fprintf(stderr, "Ошибка выделения памяти в merge.\n");
+        fprintf(stderr, "Ошибка выделения памяти в hmm_merge.\n");
         exit(EXIT_FAILURE);
     }
     memcpy(L, &arr[left], n1 * sizeof(int));
@@ -128,27 +163,52 @@ void merge(int arr[], int left, int mid, int right) {
 }
 
 // Классическая сортировка слиянием
-void merge_sort(int arr[], int left, int right) {
+void hmm_merge_sort(int arr[], int left, int right) {
     if (left < right) {
         int mid = left + (right - left) / 2;
-        merge_sort(arr, left, mid);
-        merge_sort(arr, mid + 1, right);
-        merge(arr, left, mid, right);
+        hmm_merge_sort(arr, left, mid);
+        hmm_merge_sort(arr, mid + 1, right);
+        hmm_merge(arr, left, mid, right);
     }
 }
 
-// Гибридная сортировка для int
-void hybrid_min_max_sort_serial(int arr[], int left, int right, int k) {
+// Генератор splitmix64 для случайной выборки опорных
+static inline uint64_t pivot_rng_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Случайная позиция в [lo, hi]
+static inline int pivot_rng_index(uint64_t *state, int lo, int hi) {
+    return lo + (int)(pivot_rng_next(state) % (uint64_t)(hi - lo + 1));
+}
+
+// Выбор пары опорных значений (нижнее не больше верхнего). При rng == NULL
+// позиции выборки фиксированы, иначе берутся случайно из нижней и верхней половин
+static void select_pivots(int arr[], int left, int right, uint64_t *rng, int *lower, int *upper) {
     int segment_size = right - left + 1;
-    int threshold = get_adaptive_threshold(segment_size);
-    if (segment_size <= threshold) {
-        insertion_sort(arr, left, right);
-        return;
+    int i_med_low, i_med_high;
+    if (!rng) {
+        i_med_low = hmm_select_lower_pivot(arr, left, right, segment_size);
+        i_med_high = hmm_select_upper_pivot(arr, left, right, segment_size);
+    } else {
+        int mid = left + segment_size / 2;
+        int lo[5], hi[5];
+        for (int i = 0; i < 5; i++) {
+            lo[i] = pivot_rng_index(rng, left, mid);
+            hi[i] = pivot_rng_index(rng, mid, right);
+        }
+        if (segment_size < hmm_tuning_profile.int_params.median5_threshold) {
+            i_med_low = hmm_median_of_three_index(arr, lo[0], lo[1], lo[2]);
+            i_med_high = hmm_median_of_three_index(arr, hi[0], hi[1], hi[2]);
+        } else {
+            i_med_low = hmm_median_of_five_index(arr, lo[0], lo[1], lo[2], lo[3], lo[4]);
+            i_med_high = hmm_median_of_five_index(arr, hi[0], hi[1], hi[2], hi[3], hi[4]);
+        }
     }
-    
-    int i_med_low = select_lower_pivot(arr, left, right, segment_size);
     int lowerPivot = arr[i_med_low];
-    int i_med_high = select_upper_pivot(arr, left, right, segment_size);
     int upperPivot = arr[i_med_high];
     
     if (lowerPivot > upperPivot) {
@@ -156,7 +216,64 @@ void hybrid_min_max_sort_serial(int arr[], int left, int right, int k) {
         lowerPivot = arr[i_med_low];
         upperPivot = arr[i_med_high];
     }
-    
+    *lower = lowerPivot;
+    *upper = upperPivot;
+}
+
+// Предел глубины разбиений: 2 * floor(log2 n); глубже – сортировка слиянием
+int hmm_depth_limit(size_t n) {
+    int depth = 0;
+    while (n > 1) {
+        depth += 2;
+        n >>= 1;
+    }
+    return depth;
+}
+
+// Сдвиг опорных, совпавших с границами значений сегмента [min_value, max_value],
+// внутрь: иначе крайняя часть может остаться пустой и разбиение не продвинется.
+// Если сдвинутое опорное обогнало второе, второе подтягивается к нему – так
+// серия min уходит в нижнюю часть, а серия max – в верхнюю
+void hmm_nudge_pivots(int *lowerPivot, int *upperPivot, int min_value, int max_value) {
+    int upper_nudged = 0;
+    if (*lowerPivot == min_value)
+        (*lowerPivot)++;
+    if (*upperPivot == max_value) {
+        (*upperPivot)--;
+        upper_nudged = 1;
+    }
+    if (*upperPivot < *lowerPivot) {
+        if (upper_nudged)
+            *lowerPivot = *upperPivot;
+        else
+            *upperPivot = *lowerPivot;
+    }
+}
+
+// Порядок обработки трёх частей lo[p]..hi[p]: order[0] – наибольшая (в стек
+// первой), order[1] – вторая по размеру (над ней), order[2] – наименьшая, с
+// которой цикл продолжается. Каждый уровень кладёт в стек две записи, а
+// продолжаемая часть не больше трети отрезка, поэтому глубина стека не превышает
+// 2 * log3 n + 2 записей – см. SORT_STACK_SIZE
+void hmm_part_order(const int lo[3], const int hi[3], int order[3]) {
+    int big = 0, small = 0;
+    for (int p = 1; p < 3; p++) {
+        if (hi[p] - lo[p] > hi[big] - lo[big])
+            big = p;
+        if (hi[p] - lo[p] < hi[small] - lo[small])
+            small = p;
+    }
+    if (big == small)
+        small = (big + 1) % 3;
+    order[0] = big;
+    order[1] = 3 - big - small;
+    order[2] = small;
+}
+
+// Трёхчастное разбиение по заданным опорным значениям: после него arr[left..l-1] < lowerPivot,
+// arr[l..r] между опорными, arr[r+1..right] > upperPivot
+void hmm_partition_by_pivots(int arr[], int left, int right, int lowerPivot, int upperPivot,
+                         int *out_l, int *out_r) {
     int l = left, r = right;
     for (int i = left; i <= r;) {
         if (arr[i] < lowerPivot) {
@@ -170,21 +287,249 @@ void hybrid_min_max_sort_serial(int arr[], int left, int right, int k) {
             i++;
         }
     }
+    *out_l = l;
+    *out_r = r;
+}
+
+// Трёхчастное разбиение по двум опорным из выборки
+void hmm_partition_min_max(int arr[], int left, int right, int *out_l, int *out_r) {
+    int lowerPivot, upperPivot;
+    select_pivots(arr, left, right, NULL, &lowerPivot, &upperPivot);
+    hmm_partition_by_pivots(arr, left, right, lowerPivot, upperPivot, out_l, out_r);
+}
+
+// Предварительный проход: минимум, максимум и проверка упорядоченности за один
+// проход без ветвлений (векторизуется компилятором). Возвращает 1, если сегмент уже отсортирован
+int hmm_prescan_min_max(const int arr[], int left, int right, int *out_min, int *out_max) {
+    int mn = arr[left], mx = arr[left];
+    int descents = 0;
+    for (int i = left + 1; i <= right; i++) {
+        int x = arr[i];
+        mn = (x < mn) ? x : mn;
+        mx = (x > mx) ? x : mx;
+        descents += arr[i - 1] > x;
+    }
+    *out_min = mn;
+    *out_max = mx;
+    return descents == 0;
+}
+
+// Сортировка подсчётом для сегмента со значениями в [min_value, max_value]: O(n + диапазон)
+void hmm_counting_sort_range(int arr[], int left, int right, int min_value, int max_value) {
+    size_t range = (size_t)((long long)max_value - min_value) + 1;
+    int *count = calloc(range, sizeof(int));
+    if (!count) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_counting_sort_range.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = left; i <= right; i++)
+        count[(size_t)((long long)arr[i] - min_value)]++;
+    int k = left;
+    for (size_t v = 0; v < range; v++) {
+        int value = (int)(min_value + (long long)v);
+        for (int c = count[v]; c > 0; c--)
+            arr[k++] = value;
+    }
+    free(count);
+}
+
+// Гибридная сортировка для int. Итеративный драйвер с явным стеком: две большие
+// части откладываются, цикл продолжается по наименьшей, поэтому глубина стека
+// ограничена O(log n) и не зависит от размера стека потока.
+// Вместе с сегментом хранятся границы его значений: первые известны из
+// предварительного прохода, дочерние – из опорных. Сегмент из равных значений
+// пропускается, узкий по значениям – сортируется подсчётом, а совпадение
+// опорного с границей сдвигает его, чтобы равные крайние значения ушли
+// в отдельную часть, а не в сортировку слиянием.
+// Глубина разбиений ограничена hmm_depth_limit, поэтому даже подобранный
+// противником вход сортируется за O(n log n).
+// min_value/max_value – границы значений arr[left..right] (не обязательно точные)
+static void sort_int(int arr[], int left, int right, int min_value, int max_value, uint64_t *rng) {
+    int stack_left[SORT_STACK_SIZE], stack_right[SORT_STACK_SIZE];
+    int stack_min[SORT_STACK_SIZE], stack_max[SORT_STACK_SIZE];
+    int stack_depth[SORT_STACK_SIZE];
+    HMM_TRACE_ONLY(int stack_part[SORT_STACK_SIZE]; int part = HMM_TRACE_PART_ROOT;)
+    int top = 0;
     
-    if (l == left || r == right) {
-        merge_sort(arr, left, right);
+    if (right <= left)
         return;
-    }
+    int max_depth = hmm_depth_limit(right - left + 1), depth = 0;
     
-    hybrid_min_max_sort_serial(arr, left, l - 1, k);
-    hybrid_min_max_sort_serial(arr, l, r, k);
-    hybrid_min_max_sort_serial(arr, r + 1, right, k);
+    for (;;) {
+        int segment_size = right - left + 1;
+        int threshold = hmm_get_adaptive_threshold(segment_size);
+        long long range = (long long)max_value - min_value;
+        HMM_TRACE_BEGIN(segment_size);
+        if (range == 0 || segment_size <= 1) {
+            // Все значения равны
+        } else if (segment_size <= threshold) {
+            hmm_insertion_sort(arr, left, right);
+            HMM_TRACE_END(segment_size, min_value, max_value, part, HMM_TRACE_INSERTION);
+        } else if (range < segment_size) {
+            hmm_counting_sort_range(arr, left, right, min_value, max_value);
+            HMM_TRACE_END(segment_size, min_value, max_value, part, HMM_TRACE_COUNTING);
+        } else if (depth >= max_depth) {
+            hmm_merge_sort(arr, left, right);
+            HMM_TRACE_END(segment_size, min_value, max_value, part, HMM_TRACE_MERGE);
+        } else {
+            int lowerPivot, upperPivot, l, r;
+            select_pivots(arr, left, right, rng, &lowerPivot, &upperPivot);
+            hmm_nudge_pivots(&lowerPivot, &upperPivot, min_value, max_value);
+            hmm_partition_by_pivots(arr, left, right, lowerPivot, upperPivot, &l, &r);
+            if (l == left || r == right) {
+                hmm_merge_sort(arr, left, right);
+                HMM_TRACE_END(segment_size, lowerPivot, upperPivot, part, HMM_TRACE_MERGE);
+            } else {
+                HMM_TRACE_END(segment_size, lowerPivot, upperPivot, part, HMM_TRACE_PARTITION);
+                // Наибольшая часть кладётся в стек первой, вторая по размеру – над ней
+                int lo[3] = { left, l, r + 1 }, hi[3] = { l - 1, r, right };
+                int vmin[3] = { min_value, lowerPivot, upperPivot + 1 };
+                int vmax[3] = { lowerPivot - 1, upperPivot, max_value };
+                int order[3];
+                hmm_part_order(lo, hi, order);
+                for (int q = 0; q < 2; q++) {
+                    int p = order[q];
+                    stack_left[top] = lo[p];
+                    stack_right[top] = hi[p];
+                    stack_min[top] = vmin[p];
+                    stack_depth[top] = depth + 1;
+                    HMM_TRACE_ONLY(stack_part[top] = p;)
+                    stack_max[top++] = vmax[p];
+                }
+                int small = order[2];
+                left = lo[small];
+                right = hi[small];
+                min_value = vmin[small];
+                max_value = vmax[small];
+                HMM_TRACE_ONLY(part = small;)
+                depth++;
+                continue;
+            }
+        }
+        if (top == 0)
+            break;
+        top--;
+        left = stack_left[top];
+        right = stack_right[top];
+        min_value = stack_min[top];
+        max_value = stack_max[top];
+        depth = stack_depth[top];
+        HMM_TRACE_ONLY(part = stack_part[top];)
+    }
+}
+
+void hybrid_min_max_sort_serial(int arr[], int left, int right, int k) {
+    hmm_tuning_init();
+    int min_value, max_value;
+    (void)k;
+    if (right <= left || hmm_prescan_min_max(arr, left, right, &min_value, &max_value))
+        return;
+    sort_int(arr, left, right, min_value, max_value, NULL);
+}
+
+// Вариант со случайной выборкой опорных: позиции берутся из генератора,
+// инициализированного seed, так что результат воспроизводим, а вход,
+// подобранный под фиксированные позиции, не вызывает несбалансированных разбиений
+void hybrid_min_max_sort_seeded(int arr[], int left, int right, unsigned long long seed) {
+    hmm_tuning_init();
+    uint64_t state = seed;
+    int min_value, max_value;
+    if (right <= left || hmm_prescan_min_max(arr, left, right, &min_value, &max_value))
+        return;
+    sort_int(arr, left, right, min_value, max_value, &state);
+}
+
+// Сортировка с копированием: src не меняется, результат в dst. Первый проход
+// по src совмещает предварительный (минимум, максимум, упорядоченность) с
+// подсчётом частей относительно опорных из выборки src, второй раскладывает
+// элементы src сразу по трём частям dst – отдельного копирования нет.
+// Части досортировываются на месте с уже известными границами значений
+void hybrid_min_max_sort_copy(const int src[], int dst[], int n) {
+    hmm_tuning_init();
+    if (n <= 0)
+        return;
+    int segment_size = n;
+    if (segment_size <= hmm_get_adaptive_threshold(segment_size)) {
+        memcpy(dst, src, (size_t)n * sizeof(int));
+        hmm_insertion_sort(dst, 0, n - 1);
+        return;
+    }
+    int lowerPivot = src[hmm_select_lower_pivot(src, 0, n - 1, segment_size)];
+    int upperPivot = src[hmm_select_upper_pivot(src, 0, n - 1, segment_size)];
+    if (lowerPivot > upperPivot) {
+        int t = lowerPivot;
+        lowerPivot = upperPivot;
+        upperPivot = t;
+    }
+    // Проход 1 без ветвлений: границы, спуски и размеры частей, включая
+    // равные опорным (они нужны, если опорное совпадёт с границей)
+    int mn = src[0], mx = src[0];
+    int descents = 0, below = 0, above = 0, at_lower = 0, at_upper = 0;
+    for (int i = 0; i < n; i++) {
+        int v = src[i];
+        mn = (v < mn) ? v : mn;
+        mx = (v > mx) ? v : mx;
+        descents += (i + 1 < n) && v > src[i + 1];
+        below += v < lowerPivot;
+        above += v > upperPivot;
+        at_lower += v == lowerPivot;
+        at_upper += v == upperPivot;
+    }
+    if (descents == 0) {
+        memcpy(dst, src, (size_t)n * sizeof(int));
+        return;
+    }
+    if ((long long)mx - mn < n) {
+        // Узкий диапазон: гистограмма по src и запись в dst
+        size_t range = (size_t)((long long)mx - mn) + 1;
+        int *count = calloc(range, sizeof(int));
+        if (!count) {
+            fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_sort_copy.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = 0; i < n; i++)
+            count[(size_t)((long long)src[i] - mn)]++;
+        int k = 0;
+        for (size_t v = 0; v < range; v++)
+            for (int c = count[v]; c > 0; c--)
+                dst[k++] = (int)(mn + (long long)v);
+        free(count);
+        return;
+    }
+    // Сдвиг опорных, совпавших с границами, как в hybrid_min_max_sort_serial;
+    // равные старому опорному переходят в крайнюю часть
+    if (lowerPivot == mn) {
+        lowerPivot++;
+        below += at_lower;
+    }
+    if (upperPivot == mx) {
+        upperPivot--;
+        above += at_upper;
+    }
+    if (upperPivot < lowerPivot) {
+        // Средняя часть схлопнулась в значение, которое не подсчитано, –
+        // обычный путь через копию
+        memcpy(dst, src, (size_t)n * sizeof(int));
+        sort_int(dst, 0, n - 1, mn, mx, NULL);
+        return;
+    }
+    // Проход 2 без ветвлений: раскладка по частям [0, below), [below, n - above),
+    // [n - above, n); номер части выбирает курсор записи
+    int pos[3] = { 0, below, n - above };
+    for (int i = 0; i < n; i++) {
+        int v = src[i];
+        int part = 1 - (v < lowerPivot) + (v > upperPivot);
+        dst[pos[part]++] = v;
+    }
+    sort_int(dst, 0, below - 1, mn, lowerPivot - 1, NULL);
+    sort_int(dst, below, n - above - 1, lowerPivot, upperPivot, NULL);
+    sort_int(dst, n - above, n - 1, upperPivot + 1, mx, NULL);
 }
 
 /* ==================== Функции сортировки для double ==================== */
 
 // Сортировка вставками для double
-void insertion_sort_double(double arr[], int low, int high) {
+void hmm_insertion_sort_double(double arr[], int low, int high) {
     for (int i = low + 1; i <= high; i++) {
         double key = arr[i];
         int j = i - 1;
@@ -196,8 +541,14 @@ void insertion_sort_double(double arr[], int low, int high) {
     }
 }
 
+// Адаптивный порог для double
+int hmm_get_adaptive_threshold_double(int segment_size) {
+    int threshold = hmm_tuning_profile.double_params.insertion_threshold;
+    return (segment_size < threshold) ? segment_size : threshold;
+}
+
 // Медиана из 5 элементов для double (возвращает индекс)
-int median_of_five_index_double(const double arr[], int i1, int i2, int i3, int i4, int i5) {
+int hmm_median_of_five_index_double(const double arr[], int i1, int i2, int i3, int i4, int i5) {
     int indices[5] = { i1, i2, i3, i4, i5 };
     for (int i = 1; i < 5; i++) {
         int temp = indices[i];
@@ -212,7 +563,7 @@ int median_of_five_index_double(const double arr[], int i1, int i2, int i3, int
 }
 
 // Медиана из 3 элементов для double (возвращает индекс)
-int median_of_three_index_double(const double arr[], int i1, int i2, int i3) {
+int hmm_median_of_three_index_double(const double arr[], int i1, int i2, int i3) {
     if (arr[i1] < arr[i2]) {
         if (arr[i2] < arr[i3])
             return i2;
@@ -231,32 +582,32 @@ int median_of_three_index_double(const double arr[], int i1, int i2, int i3) {
 }
 
 // Выбор нижнего опорного элемента для double
-int select_lower_pivot_double(const double arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
-        return median_of_three_index_double(arr, left, left + segment_size / 4, left + segment_size / 2);
+int hmm_select_lower_pivot_double(const double arr[], int left, int right, int segment_size) {
+    if (segment_size < hmm_tuning_profile.double_params.median5_threshold) {
+        return hmm_median_of_three_index_double(arr, left, left + segment_size / 4, left + segment_size / 2);
     } else {
-        return median_of_five_index_double(arr, left, left + segment_size / 8, left + segment_size / 4,
+        return hmm_median_of_five_index_double(arr, left, left + segment_size / 8, left + segment_size / 4,
                                             left + (3 * segment_size) / 8, left + segment_size / 2);
     }
 }
 
 // Выбор верхнего опорного элемента для double
-int select_upper_pivot_double(const double arr[], int left, int right, int segment_size) {
-    if (segment_size < 128) {
-        return median_of_three_index_double(arr, left + segment_size / 2, left + (3 * segment_size) / 4, right);
+int hmm_select_upper_pivot_double(const double arr[], int left, int right, int segment_size) {
+    if (segment_size < hmm_tuning_profile.double_params.median5_threshold) {
+        return hmm_median_of_three_index_double(arr, left + segment_size / 2, left + (3 * segment_size) / 4, right);
     } else {
-        return median_of_five_index_double(arr, left + segment_size / 2, left + (5 * segment_size) / 8,
+        return hmm_median_of_five_index_double(arr, left + segment_size / 2, left + (5 * segment_size) / 8,
                                             left + (3 * segment_size) / 4, left + (7 * segment_size) / 8, right);
     }
 }
 
 // Слияние для double
-void merge_double(double arr[], int left, int mid, int right) {
+void hmm_merge_double(double arr[], int left, int mid, int right) {
     int n1 = mid - left + 1, n2 = right - mid;
     double *L = malloc(n1 * sizeof(double));
     double *R = malloc(n2 * sizeof(double));
     if (!L || !R) {
-        fprintf(stderr, "Ошибка выделения памяти в merge_double.\n");
+        fprintf(stderr, "Ошибка выделения памяти в hmm_merge_double.\n");
         exit(EXIT_FAILURE);
     }
     memcpy(L, &arr[left], n1 * sizeof(double));
@@ -277,27 +628,22 @@ void merge_double(double arr[], int left, int mid, int right) {
 }
 
 // Классическая сортировка слиянием для double
-void merge_sort_double(double arr[], int left, int right) {
+void hmm_merge_sort_double(double arr[], int left, int right) {
     if (left < right) {
         int mid = left + (right - left) / 2;
-        merge_sort_double(arr, left, mid);
-        merge_sort_double(arr, mid + 1, right);
-        merge_double(arr, left, mid, right);
+        hmm_merge_sort_double(arr, left, mid);
+        hmm_merge_sort_double(arr, mid + 1, right);
+        hmm_merge_double(arr, left, mid, right);
     }
 }
 
-// Гибридная сортировка для double
-void hybrid_min_max_sort_serial_double(double arr[], int left, int right, int k) {
+// Трёхчастное разбиение по двум опорным для double: после него arr[left..l-1] < нижнего,
+// arr[l..r] между опорными, arr[r+1..right] > верхнего
+void hmm_partition_min_max_double(double arr[], int left, int right, int *out_l, int *out_r) {
     int segment_size = right - left + 1;
-    int threshold = get_adaptive_threshold(segment_size);
-    if (segment_size <= threshold) {
-        insertion_sort_double(arr, left, right);
-        return;
-    }
-    
-    int i_med_low = select_lower_pivot_double(arr, left, right, segment_size);
+    int i_med_low = hmm_select_lower_pivot_double(arr, left, right, segment_size);
     double lowerPivot = arr[i_med_low];
-    int i_med_high = select_upper_pivot_double(arr, left, right, segment_size);
+    int i_med_high = hmm_select_upper_pivot_double(arr, left, right, segment_size);
     double upperPivot = arr[i_med_high];
     
     if (lowerPivot > upperPivot) {
@@ -319,14 +665,573 @@ void hybrid_min_max_sort_serial_double(double arr[], int left, int right, int k)
             i++;
         }
     }
+    *out_l = l;
+    *out_r = r;
+}
+
+// Гибридная сортировка для double. Итеративный драйвер с явным стеком: две большие
+// части откладываются, цикл продолжается по наименьшей, поэтому глубина стека
+// ограничена O(log n) и не зависит от размера стека потока. Глубина разбиений
+// ограничена hmm_depth_limit, после него сегмент досортировывается слиянием
+void hybrid_min_max_sort_serial_double(double arr[], int left, int right, int k) {
+    int stack_left[SORT_STACK_SIZE], stack_right[SORT_STACK_SIZE];
+    int stack_depth[SORT_STACK_SIZE];
+    int top = 0;
+    int max_depth = hmm_depth_limit(right > left ? right - left + 1 : 1), depth = 0;
+    (void)k;
+    hmm_tuning_init();
     
-    if (l == left || r == right) {
-        merge_sort_double(arr, left, right);
+    for (;;) {
+        int segment_size = right - left + 1;
+        int threshold = hmm_get_adaptive_threshold_double(segment_size);
+        if (segment_size <= threshold) {
+            hmm_insertion_sort_double(arr, left, right);
+        } else if (depth >= max_depth) {
+            hmm_merge_sort_double(arr, left, right);
+        } else {
+            int l, r;
+            hmm_partition_min_max_double(arr, left, right, &l, &r);
+            if (l == left || r == right) {
+                hmm_merge_sort_double(arr, left, right);
+            } else {
+                // Наибольшая часть кладётся в стек первой, вторая по размеру – над ней
+                int lo[3] = { left, l, r + 1 }, hi[3] = { l - 1, r, right };
+                int order[3];
+                hmm_part_order(lo, hi, order);
+                for (int q = 0; q < 2; q++) {
+                    stack_left[top] = lo[order[q]];
+                    stack_depth[top] = depth + 1;
+                    stack_right[top++] = hi[order[q]];
+                }
+                int small = order[2];
+                left = lo[small];
+                right = hi[small];
+                depth++;
+                continue;
+            }
+        }
+        if (top == 0)
+            break;
+        top--;
+        left = stack_left[top];
+        right = stack_right[top];
+        depth = stack_depth[top];
+    }
+}
+
+
+/* ==================== Дозапись в отсортированный массив ==================== */
+
+#define MIN_GALLOP 7
+
+// Экспоненциальный поиск с конца: сколько последних элементов a[lo..hi]
+// строго больше key (или не меньше key, если strict == 0)
+static int gallop_from_end(int key, const int a[], int lo, int hi, int strict) {
+    int len = hi - lo + 1;
+    int prev = 0, ofs = 1;
+    while (ofs <= len && (strict ? a[hi - ofs + 1] > key : a[hi - ofs + 1] >= key)) {
+        prev = ofs;
+        ofs = 2 * ofs;
+    }
+    int upper = (ofs > len) ? len : ofs - 1;
+    while (prev < upper) {
+        int mid = prev + (upper - prev + 1) / 2;
+        if (strict ? a[hi - mid + 1] > key : a[hi - mid + 1] >= key)
+            prev = mid;
+        else
+            upper = mid - 1;
+    }
+    return prev;
+}
+
+// Первый индекс в a[lo..hi), значение которого больше key (strict) или не меньше key
+static int bound_index(int key, const int a[], int lo, int hi, int strict) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strict ? a[mid] <= key : a[mid] < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Досортировка дописанного хвоста: arr[0..sorted_len-1] уже отсортирован,
+// arr[sorted_len..total_len-1] сортируется гибридной сортировкой и вливается
+// в префикс слиянием с галопом. Буфер – не больше длины хвоста, O(m log m + n).
+void hmm_append_sorted(int arr[], int sorted_len, int total_len) {
+    if (total_len - sorted_len <= 0)
         return;
+    hybrid_min_max_sort_serial(arr, sorted_len, total_len - 1, 2);
+    if (sorted_len == 0 || arr[sorted_len - 1] <= arr[sorted_len])
+        return;
+
+    // Элементы префикса, не превосходящие минимума хвоста, уже на своих местах,
+    // как и элементы хвоста, не меньшие максимума префикса
+    int start = bound_index(arr[sorted_len], arr, 0, sorted_len, 1);
+    int end = bound_index(arr[sorted_len - 1], arr, sorted_len, total_len, 0);
+    int nb = end - sorted_len;
+    int *buf = malloc(nb * sizeof(int));
+    if (!buf) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_append_sorted.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(buf, &arr[sorted_len], nb * sizeof(int));
+
+    // Слияние с конца: равные элементы хвоста остаются после элементов префикса
+    int i = sorted_len - 1, j = nb - 1, k = end - 1;
+    int wins_a = 0, wins_b = 0;
+    while (i >= start && j >= 0) {
+        if (arr[i] > buf[j]) {
+            arr[k--] = arr[i--];
+            wins_a++;
+            wins_b = 0;
+        } else {
+            arr[k--] = buf[j--];
+            wins_b++;
+            wins_a = 0;
+        }
+        if (i < start || j < 0)
+            break;
+        if (wins_a >= MIN_GALLOP) {
+            int c = gallop_from_end(buf[j], arr, start, i, 1);
+            memmove(&arr[k - c + 1], &arr[i - c + 1], c * sizeof(int));
+            k -= c;
+            i -= c;
+            wins_a = 0;
+        } else if (wins_b >= MIN_GALLOP) {
+            int c = gallop_from_end(arr[i], buf, 0, j, 0);
+            memcpy(&arr[k - c + 1], &buf[j - c + 1], c * sizeof(int));
+            k -= c;
+            j -= c;
+            wins_b = 0;
+        }
+    }
+    if (j >= 0)
+        memcpy(&arr[start], buf, (j + 1) * sizeof(int));
+    free(buf);
+}
+
+// Экспоненциальный поиск с конца для double
+static int gallop_from_end_double(double key, const double a[], int lo, int hi, int strict) {
+    int len = hi - lo + 1;
+    int prev = 0, ofs = 1;
+    while (ofs <= len && (strict ? a[hi - ofs + 1] > key : a[hi - ofs + 1] >= key)) {
+        prev = ofs;
+        ofs = 2 * ofs;
+    }
+    int upper = (ofs > len) ? len : ofs - 1;
+    while (prev < upper) {
+        int mid = prev + (upper - prev + 1) / 2;
+        if (strict ? a[hi - mid + 1] > key : a[hi - mid + 1] >= key)
+            prev = mid;
+        else
+            upper = mid - 1;
+    }
+    return prev;
+}
+
+// Двоичный поиск границы для double
+static int bound_index_double(double key, const double a[], int lo, int hi, int strict) {
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strict ? a[mid] <= key : a[mid] < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Досортировка дописанного хвоста для double
+void hmm_append_sorted_double(double arr[], int sorted_len, int total_len) {
+    if (total_len - sorted_len <= 0)
+        return;
+    hybrid_min_max_sort_serial_double(arr, sorted_len, total_len - 1, 2);
+    if (sorted_len == 0 || arr[sorted_len - 1] <= arr[sorted_len])
+        return;
+
+    int start = bound_index_double(arr[sorted_len], arr, 0, sorted_len, 1);
+    int end = bound_index_double(arr[sorted_len - 1], arr, sorted_len, total_len, 0);
+    int nb = end - sorted_len;
+    double *buf = malloc(nb * sizeof(double));
+    if (!buf) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_append_sorted_double.\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(buf, &arr[sorted_len], nb * sizeof(double));
+
+    int i = sorted_len - 1, j = nb - 1, k = end - 1;
+    int wins_a = 0, wins_b = 0;
+    while (i >= start && j >= 0) {
+        if (arr[i] > buf[j]) {
+            arr[k--] = arr[i--];
+            wins_a++;
+            wins_b = 0;
+        } else {
+            arr[k--] = buf[j--];
+            wins_b++;
+            wins_a = 0;
+        }
+        if (i < start || j < 0)
+            break;
+        if (wins_a >= MIN_GALLOP) {
+            int c = gallop_from_end_double(buf[j], arr, start, i, 1);
+            memmove(&arr[k - c + 1], &arr[i - c + 1], c * sizeof(double));
+            k -= c;
+            i -= c;
+            wins_a = 0;
+        } else if (wins_b >= MIN_GALLOP) {
+            int c = gallop_from_end_double(arr[i], buf, 0, j, 0);
+            memcpy(&arr[k - c + 1], &buf[j - c + 1], c * sizeof(double));
+            k -= c;
+            j -= c;
+            wins_b = 0;
+        }
+    }
+    if (j >= 0)
+        memcpy(&arr[start], buf, (j + 1) * sizeof(double));
+    free(buf);
+}
+
+/* ==================== Совместимая с qsort точка входа ==================== */
+
+// Элементы читаются через типы с may_alias: массив пользователя может
+// состоять из любых структур того же размера. Выравнивание 16-байтного типа –
+// максимальное для элемента такого размера, чтобы компаратор получал
+// правильно выровненные копии
+typedef uint16_t __attribute__((may_alias)) qsort_u16_t;
+typedef uint32_t __attribute__((may_alias)) qsort_u32_t;
+typedef uint64_t __attribute__((may_alias)) qsort_u64_t;
+typedef struct { uint64_t lo, hi; } __attribute__((may_alias, aligned(16))) qsort_u128;
+typedef void *qsort_ptr;
+
+// Специализированная версия допустима, только если base выровнен под её тип
+#define QSORT_ALIGNED(base, size, T) ((((uintptr_t)(base)) | (size)) % _Alignof(T) == 0)
+
+// Сравнение элементов напрямую и через указатели (косвенная сортировка)
+#define QSORT_CMP_DIRECT(cmp, pa, pb) (cmp)((pa), (pb))
+#define QSORT_CMP_INDIRECT(cmp, pa, pb) (cmp)(*(pa), *(pb))
+// Встроенное сравнение беззнаковых ключей (компаратор не используется)
+#define QSORT_CMP_KEY(cmp, pa, pb) ((void)(cmp), (*(pa) > *(pb)) - (*(pa) < *(pb)))
+
+// Шаблон гибридной сортировки для элемента фиксированного размера: элементы
+// копируются как значения типа T, поэтому обмен и сдвиг компилируются в
+// одну-две машинные пересылки. Границы сегментов полуоткрытые [lo, hi).
+#define QSORT_DEFINE(NAME, T, CMP)                                                       \
+static void NAME##_insertion(T *a, size_t lo, size_t hi, hmm_cmp_fn cmp) {               \
+    for (size_t i = lo + 1; i < hi; i++) {                                               \
+        T key = a[i];                                                                    \
+        size_t j = i;                                                                    \
+        while (j > lo && CMP(cmp, &a[j - 1], &key) > 0) {                                \
+            a[j] = a[j - 1];                                                             \
+            j--;                                                                         \
+        }                                                                                \
+        a[j] = key;                                                                      \
+    }                                                                                    \
+}                                                                                        \
+                                                                                         \
+static void NAME##_sift_down(T *a, size_t root, size_t n, hmm_cmp_fn cmp) {              \
+    T v = a[root];                                                                       \
+    size_t child;                                                                        \
+    while ((child = 2 * root + 1) < n) {                                                 \
+        if (child + 1 < n && CMP(cmp, &a[child], &a[child + 1]) < 0)                     \
+            child++;                                                                     \
+        if (CMP(cmp, &v, &a[child]) >= 0)                                                \
+            break;                                                                       \
+        a[root] = a[child];                                                              \
+        root = child;                                                                    \
+    }                                                                                    \
+    a[root] = v;                                                                         \
+}                                                                                        \
+                                                                                         \
+static void NAME##_heap_sort(T *a, size_t n, hmm_cmp_fn cmp) {                           \
+    for (size_t i = n / 2; i-- > 0;)                                                     \
+        NAME##_sift_down(a, i, n, cmp);                                                  \
+    for (size_t i = n - 1; i > 0; i--) {                                                 \
+        T t = a[0];                                                                      \
+        a[0] = a[i];                                                                     \
+        a[i] = t;                                                                        \
+        NAME##_sift_down(a, 0, i, cmp);                                                  \
+    }                                                                                    \
+}                                                                                        \
+                                                                                         \
+static size_t NAME##_median3(const T *a, size_t i1, size_t i2, size_t i3,                \
+                             hmm_cmp_fn cmp) {                                           \
+    if (CMP(cmp, &a[i1], &a[i2]) < 0) {                                                  \
+        if (CMP(cmp, &a[i2], &a[i3]) < 0)                                                \
+            return i2;                                                                   \
+        return (CMP(cmp, &a[i1], &a[i3]) < 0) ? i3 : i1;                                 \
+    }                                                                                    \
+    if (CMP(cmp, &a[i1], &a[i3]) < 0)                                                    \
+        return i1;                                                                       \
+    return (CMP(cmp, &a[i2], &a[i3]) < 0) ? i3 : i2;                                     \
+}                                                                                        \
+                                                                                         \
+static size_t NAME##_median5(const T *a, size_t i1, size_t i2, size_t i3, size_t i4,     \
+                             size_t i5, hmm_cmp_fn cmp) {                                \
+    size_t idx[5] = { i1, i2, i3, i4, i5 };                                              \
+    for (int i = 1; i < 5; i++) {                                                        \
+        size_t t = idx[i];                                                               \
+        int j = i - 1;                                                                   \
+        while (j >= 0 && CMP(cmp, &a[idx[j]], &a[t]) > 0) {                              \
+            idx[j + 1] = idx[j];                                                         \
+            j--;                                                                         \
+        }                                                                                \
+        idx[j + 1] = t;                                                                  \
+    }                                                                                    \
+    return idx[2];                                                                       \
+}                                                                                        \
+                                                                                         \
+static void NAME##_sort(T *a, size_t lo, size_t hi, hmm_cmp_fn cmp, int depth) {         \
+    while (hi - lo > (size_t)hmm_tuning_profile.qsort_params.insertion_threshold) {      \
+        size_t n = hi - lo;                                                              \
+        if (depth-- == 0) {                                                              \
+            NAME##_heap_sort(a + lo, n, cmp);                                            \
+            return;                                                                      \
+        }                                                                                \
+        size_t il, iu;                                                                   \
+        if (n < (size_t)hmm_tuning_profile.qsort_params.median5_threshold) {             \
+            il = NAME##_median3(a, lo, lo + n / 4, lo + n / 2, cmp);                     \
+            iu = NAME##_median3(a, lo + n / 2, lo + (3 * n) / 4, hi - 1, cmp);           \
+        } else {                                                                         \
+            il = NAME##_median5(a, lo, lo + n / 8, lo + n / 4, lo + (3 * n) / 8,         \
+                                lo + n / 2, cmp);                                        \
+            iu = NAME##_median5(a, lo + n / 2, lo + (5 * n) / 8, lo + (3 * n) / 4,       \
+                                lo + (7 * n) / 8, hi - 1, cmp);                          \
+        }                                                                                \
+        T lp = a[il], up = a[iu];                                                        \
+        if (CMP(cmp, &lp, &up) > 0) {                                                    \
+            T t = lp;                                                                    \
+            lp = up;                                                                     \
+            up = t;                                                                      \
+        }                                                                                \
+        size_t l = lo, r = hi;                                                           \
+        for (size_t i = lo; i < r;) {                                                    \
+            if (CMP(cmp, &a[i], &lp) < 0) {                                              \
+                T t = a[i];                                                              \
+                a[i++] = a[l];                                                           \
+                a[l++] = t;                                                              \
+            } else if (CMP(cmp, &a[i], &up) > 0) {                                       \
+                T t = a[i];                                                              \
+                a[i] = a[--r];                                                           \
+                a[r] = t;                                                                \
+            } else {                                                                     \
+                i++;                                                                     \
+            }                                                                            \
+        }                                                                                \
+        if (l == lo && r == hi) {                                                        \
+            /* Все элементы между опорными, то есть lp и up – минимум и */               \
+            /* максимум сегмента. При lp == up сегмент из равных, иначе – */             \
+            /* сдвиг опорных с границ (как hmm_nudge_pivots): элементы, */               \
+            /* равные lp и up, уходят в готовые крайние части, цикл */                   \
+            /* продолжается по середине. Обе крайние части непусты */                    \
+            if (CMP(cmp, &lp, &up) == 0)                                                 \
+                return;                                                                  \
+            for (size_t i = lo; i < r;) {                                                \
+                if (CMP(cmp, &a[i], &lp) == 0) {                                         \
+                    T t = a[i];                                                          \
+                    a[i++] = a[l];                                                       \
+                    a[l++] = t;                                                          \
+                } else if (CMP(cmp, &a[i], &up) == 0) {                                  \
+                    T t = a[i];                                                          \
+                    a[i] = a[--r];                                                       \
+                    a[r] = t;                                                            \
+                } else {                                                                 \
+                    i++;                                                                 \
+                }                                                                        \
+            }                                                                            \
+            lo = l;                                                                      \
+            hi = r;                                                                      \
+            continue;                                                                    \
+        }                                                                                \
+        /* Рекурсия в две меньшие части, цикл по наибольшей: глубина O(log n) */         \
+        size_t s1 = l - lo, s2 = r - l, s3 = hi - r;                                     \
+        if (s1 >= s2 && s1 >= s3) {                                                      \
+            NAME##_sort(a, l, r, cmp, depth);                                            \
+            NAME##_sort(a, r, hi, cmp, depth);                                           \
+            hi = l;                                                                      \
+        } else if (s2 >= s3) {                                                           \
+            NAME##_sort(a, lo, l, cmp, depth);                                           \
+            NAME##_sort(a, r, hi, cmp, depth);                                           \
+            lo = l;                                                                      \
+            hi = r;                                                                      \
+        } else {                                                                         \
+            NAME##_sort(a, lo, l, cmp, depth);                                           \
+            NAME##_sort(a, l, r, cmp, depth);                                            \
+            lo = r;                                                                      \
+        }                                                                                \
+        if (CMP(cmp, &lp, &up) == 0 && lo == l && hi == r)                               \
+            return;                                                                      \
+    }                                                                                    \
+    NAME##_insertion(a, lo, hi, cmp);                                                    \
+}
+
+QSORT_DEFINE(qsort_u8, uint8_t, QSORT_CMP_DIRECT)
+QSORT_DEFINE(qsort_u16, qsort_u16_t, QSORT_CMP_DIRECT)
+QSORT_DEFINE(qsort_u32, qsort_u32_t, QSORT_CMP_DIRECT)
+QSORT_DEFINE(qsort_u64, qsort_u64_t, QSORT_CMP_DIRECT)
+QSORT_DEFINE(qsort_u128, qsort_u128, QSORT_CMP_DIRECT)
+QSORT_DEFINE(qsort_ptr, qsort_ptr, QSORT_CMP_INDIRECT)
+QSORT_DEFINE(qsort_key64, qsort_u64_t, QSORT_CMP_KEY)
+
+// Пирамидальная сортировка элементов произвольного размера (побайтовый обмен);
+// используется, только если не удалось выделить память под косвенную сортировку
+static void qsort_bytes_swap(char *a, char *b, size_t size) {
+    while (size--) {
+        char t = *a;
+        *a++ = *b;
+        *b++ = t;
+    }
+}
+
+static void qsort_bytes_sift_down(char *base, size_t root, size_t n, size_t size, hmm_cmp_fn cmp) {
+    size_t child;
+    while ((child = 2 * root + 1) < n) {
+        if (child + 1 < n && cmp(base + child * size, base + (child + 1) * size) < 0)
+            child++;
+        if (cmp(base + root * size, base + child * size) >= 0)
+            break;
+        qsort_bytes_swap(base + root * size, base + child * size, size);
+        root = child;
+    }
+}
+
+static void qsort_bytes_heap_sort(char *base, size_t n, size_t size, hmm_cmp_fn cmp) {
+    for (size_t i = n / 2; i-- > 0;)
+        qsort_bytes_sift_down(base, i, n, size, cmp);
+    for (size_t i = n - 1; i > 0; i--) {
+        qsort_bytes_swap(base, base + i * size, size);
+        qsort_bytes_sift_down(base, 0, i, size, cmp);
     }
-    
-    hybrid_min_max_sort_serial_double(arr, left, l - 1, k);
-    hybrid_min_max_sort_serial_double(arr, l, r, k);
-    hybrid_min_max_sort_serial_double(arr, r + 1, right, k);
 }
 
+// Замена qsort: для элементов размером 1/2/4/8/16 байт при подходящем
+// выравнивании base – специализированные версии, для остальных – сортировка
+// массива указателей и перестановка циклами
+void hmm_qsort(void *base, size_t n, size_t size, hmm_cmp_fn cmp) {
+    hmm_tuning_init();
+    if (n < 2 || size == 0)
+        return;
+    int depth = hmm_depth_limit(n);
+    switch (size) {
+    case 1:
+        qsort_u8_sort(base, 0, n, cmp, depth);
+        return;
+    case 2:
+        if (!QSORT_ALIGNED(base, size, qsort_u16_t))
+            break;
+        qsort_u16_sort(base, 0, n, cmp, depth);
+        return;
+    case 4:
+        if (!QSORT_ALIGNED(base, size, qsort_u32_t))
+            break;
+        qsort_u32_sort(base, 0, n, cmp, depth);
+        return;
+    case 8:
+        if (!QSORT_ALIGNED(base, size, qsort_u64_t))
+            break;
+        qsort_u64_sort(base, 0, n, cmp, depth);
+        return;
+    case 16:
+        if (!QSORT_ALIGNED(base, size, qsort_u128))
+            break;
+        qsort_u128_sort(base, 0, n, cmp, depth);
+        return;
+    }
+
+    char *a = base;
+    qsort_ptr *ptrs = malloc(n * sizeof(qsort_ptr));
+    char *tmp = malloc(size);
+    if (!ptrs || !tmp) {
+        free(ptrs);
+        free(tmp);
+        qsort_bytes_heap_sort(a, n, size, cmp);
+        return;
+    }
+    for (size_t i = 0; i < n; i++)
+        ptrs[i] = a + i * size;
+    qsort_ptr_sort(ptrs, 0, n, cmp, depth);
+
+    // ptrs[i] указывает на элемент, который должен стоять на позиции i
+    for (size_t i = 0; i < n; i++) {
+        if (ptrs[i] == a + i * size)
+            continue;
+        memcpy(tmp, a + i * size, size);
+        size_t j = i;
+        for (;;) {
+            size_t k = (size_t)((char *)ptrs[j] - a) / size;
+            ptrs[j] = a + j * size;
+            if (k == i) {
+                memcpy(a + j * size, tmp, size);
+                break;
+            }
+            memcpy(a + j * size, a + k * size, size);
+            j = k;
+        }
+    }
+    free(tmp);
+    free(ptrs);
+}
+
+/* ==================== Полный порядок для float и double ==================== */
+
+// Доступ к битам массива float/double на месте без нарушения правил алиасинга
+typedef uint32_t __attribute__((may_alias)) bits32_alias;
+typedef uint64_t __attribute__((may_alias)) bits64_alias;
+
+// Биективное отображение битов IEEE 754 в беззнаковые ключи с полным порядком:
+// у отрицательных инвертируются все биты, у остальных – знаковый, так что
+// -inf < ... < -0 < +0 < ... < +inf. Затем ключи сдвигаются по модулю 2^w на
+// ключ -inf: отрицательные NaN (они были меньше -inf) уходят в самый верх,
+// и все NaN оказываются в конце: ... < +inf < +NaN < -NaN
+#define TOTAL_SHIFT64 0x000FFFFFFFFFFFFFULL
+#define TOTAL_SHIFT32 0x007FFFFFu
+
+static inline uint64_t total_key64(uint64_t bits) {
+    bits = (bits >> 63) ? ~bits : bits ^ 0x8000000000000000ULL;
+    return bits - TOTAL_SHIFT64;
+}
+
+static inline uint64_t total_bits64(uint64_t key) {
+    key += TOTAL_SHIFT64;
+    return (key >> 63) ? key ^ 0x8000000000000000ULL : ~key;
+}
+
+static inline uint32_t total_key32(uint32_t bits) {
+    bits = (bits >> 31) ? ~bits : bits ^ 0x80000000u;
+    return bits - TOTAL_SHIFT32;
+}
+
+static inline uint32_t total_bits32(uint32_t key) {
+    key += TOTAL_SHIFT32;
+    return (key >> 31) ? key ^ 0x80000000u : ~key;
+}
+
+// Сортировка double в полном порядке: NaN в конце, -0 перед +0. Массив на
+// месте переводится в целочисленные ключи, сортируется целочисленным
+// ядром без NaN-особенностей сравнения и переводится обратно
+void hybrid_min_max_sort_total_double(double arr[], int n) {
+    bits64_alias *keys = (bits64_alias *)arr;
+    if (n < 2)
+        return;
+    hmm_tuning_init();
+    for (int i = 0; i < n; i++)
+        keys[i] = total_key64(keys[i]);
+    qsort_key64_sort(keys, 0, (size_t)n, NULL, hmm_depth_limit((size_t)n));
+    for (int i = 0; i < n; i++)
+        keys[i] = total_bits64(keys[i]);
+}
+
+// То же для float: 32-битные ключи со смещённым знаком становятся int
+// с тем же порядком и сортируются hybrid_min_max_sort_serial
+void hybrid_min_max_sort_total_float(float arr[], int n) {
+    bits32_alias *keys = (bits32_alias *)arr;
+    if (n < 2)
+        return;
+    for (int i = 0; i < n; i++)
+        keys[i] = total_key32(keys[i]) ^ 0x80000000u;
+    hybrid_min_max_sort_serial((int *)keys, 0, n - 1, 2);
+    for (int i = 0; i < n; i++)
+        keys[i] = total_bits32(keys[i] ^ 0x80000000u);
+}
@@ -1,21 +1,22 @@
 /*
  * min_max_sort.cpp
  *
- * Реализация гибридной сортировки Min-Max для типов int и double на C++.
+ * Реализация гибридной сортировки Min-Max для int на C++ (std::vector).
+ * Все функции – в пространстве имён hmm, объявления – в min_max_sort.hpp.
  */
 
-#include <iostream>
-#include <vector>
+#include "min_max_sort.hpp"
 #include <algorithm>
-#include <cstdlib>
-#include <cstring>
-#include <chrono> // Для замера времени
 
-#define THRESHOLD_DEFAULT 64
-#define SMALL_SIZE 128
+namespace hmm {
 
 /* ==================== Вспомогательные функции ==================== */
 
+// Пороги из профиля настройки (те же, что у C-драйвера для int)
+static const hmm_tuning_params& int_params() {
+    return hmm_tuning_profile.int_params;
+}
+
 // Обмен значений (универсальный шаблон)
 template <typename T>
 inline void swap(T& a, T& b) {
@@ -41,7 +42,8 @@ void insertion_sort(std::vector<int>& arr, int low, int high) {
 
 // Адаптивный порог
 int get_adaptive_threshold(int segment_size) {
-    return (segment_size < THRESHOLD_DEFAULT) ? segment_size : THRESHOLD_DEFAULT;
+    int threshold = int_params().insertion_threshold;
+    return (segment_size < threshold) ? segment_size : threshold;
 }
 
 // Быстрая медиана из пяти элементов с использованием std::nth_element
@@ -77,7 +79,7 @@ int median_of_three_index(const std::vector<int>& arr, int i1, int i2, int i3) {
 
 // Выбор нижнего опорного элемента (для левого сегмента)
 int select_lower_pivot(const std::vector<int>& arr, int left, int right, int segment_size) {
-    if (segment_size < SMALL_SIZE) {
+    if (segment_size < int_params().median5_threshold) {
         return median_of_three_index(arr, left, left + segment_size / 4, left + segment_size / 2);
     } else {
         return median_of_five_index(arr, left, left + segment_size / 8, left + segment_size / 4,
@@ -87,7 +89,7 @@ int select_lower_pivot(const std::vector<int>& arr, int left, int right, int seg
 
 // Выбор верхнего опорного элемента (для правого сегмента)
 int select_upper_pivot(const std::vector<int>& arr, int left, int right, int segment_size) {
-    if (segment_size < SMALL_SIZE) {
+    if (segment_size < int_params().median5_threshold) {
         return median_of_three_index(arr, left + segment_size / 2, left + (3 * segment_size) / 4, right);
     } else {
         return median_of_five_index(arr, left + segment_size / 2, left + (5 * segment_size) / 8,
@@ -124,14 +126,19 @@ void merge_sort(std::vector<int>& arr, int left, int right) {
     }
 }
 
-// Гибридная сортировка для int
-void hybrid_min_max_sort(std::vector<int>& arr, int left, int right, int k) {
+// Рекурсия с остатком бюджета глубины: когда он исчерпан, сегмент
+// досортировывается слиянием (как в hybrid_min_max_sort_serial)
+static void hybrid_min_max_sort_depth(std::vector<int>& arr, int left, int right, int k, int depth) {
     int segment_size = right - left + 1;
     int threshold = get_adaptive_threshold(segment_size);
     if (segment_size <= threshold) {
         insertion_sort(arr, left, right);
         return;
     }
+    if (depth == 0) {
+        merge_sort(arr, left, right);
+        return;
+    }
     
     int i_med_low = select_lower_pivot(arr, left, right, segment_size);
     int lowerPivot = arr[i_med_low];
@@ -163,27 +170,15 @@ void hybrid_min_max_sort(std::vector<int>& arr, int left, int right, int k) {
         return;
     }
     
-    hybrid_min_max_sort(arr, left, l - 1, k);
-    hybrid_min_max_sort(arr, l, r, k);
-    hybrid_min_max_sort(arr, r + 1, right, k);
+    hybrid_min_max_sort_depth(arr, left, l - 1, k, depth - 1);
+    hybrid_min_max_sort_depth(arr, l, r, k, depth - 1);
+    hybrid_min_max_sort_depth(arr, r + 1, right, k, depth - 1);
 }
 
-int main() {
-    std::vector<int> arr = {3, 6, 8, 10, 1, 2, 1, 5, 9, 4, 7, 9, 19, 284, 20, 21, 384, 39, 29, 0, 1, -34, 23};
-    int k = 2;
-
-    auto start = std::chrono::high_resolution_clock::now();
-    hybrid_min_max_sort(arr, 0, arr.size() - 1, k);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::chrono::duration<double> duration = end - start;
-
-    std::cout << "Отсортированный массив: ";
-    for (const auto& num : arr) {
-        std::cout << num << " ";
-    }
-    std::cout << std::endl;
-    std::cout << "Время выполнения: " << duration.count() << " секунд" << std::endl;
-
-    return 0;
+// Гибридная сортировка для int. Глубина разбиений ограничена 2 * floor(log2 n)
+void hybrid_min_max_sort(std::vector<int>& arr, int left, int right, int k) {
+    hmm_tuning_init();
+    hybrid_min_max_sort_depth(arr, left, right, k, hmm_depth_limit(right > left ? right - left + 1 : 1));
 }
 
+} // namespace hmm
@@ -2,31 +2,270 @@
  * min_max_sort.h
  *
  * Заголовочный файл для гибридной сортировки Min-Max для типов int и double.
+ * Все внешние символы библиотеки начинаются с hmm_ или hybrid_min_max_;
+ * C++-интерфейс (пространство имён hmm) – в min_max_sort.hpp.
  */
 
 #ifndef MIN_MAX_SORT_H
 #define MIN_MAX_SORT_H
 
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* --- Профиль настройки порогов --- */
+typedef struct {
+    int insertion_threshold;   // сегменты не длиннее – сортировка вставками
+    int median5_threshold;     // с этого размера опорные – медианы из 5, иначе из 3
+} hmm_tuning_params;
+
+typedef struct {
+    hmm_tuning_params int_params;
+    hmm_tuning_params double_params;
+    hmm_tuning_params qsort_params;
+} hmm_tuning;
+
+extern hmm_tuning hmm_tuning_profile;
+
+// Загрузка профиля из HMM_TUNING_FILE (однократно; точки входа сортировок
+// вызывают её сами, HMM_TUNING_VERBOSE=1 – сообщать об ошибке загрузки)
+void hmm_tuning_init(void);
+int hmm_tuning_load(const char *path);
+int hmm_tuning_save(const char *path);
+int hmm_tuning_write_header(const char *path);
+void hmm_tuning_calibrate(int verbose);
+
 /* --- Прототипы функций для int --- */
-void insertion_sort(int arr[], int low, int high);
-int get_adaptive_threshold(int segment_size);
-int median_of_five_index(const int arr[], int i1, int i2, int i3, int i4, int i5);
-int median_of_three_index(const int arr[], int i1, int i2, int i3);
-int select_lower_pivot(const int arr[], int left, int right, int segment_size);
-int select_upper_pivot(const int arr[], int left, int right, int segment_size);
-void merge(int arr[], int left, int mid, int right);
-void merge_sort(int arr[], int left, int right);
+void hmm_insertion_sort(int arr[], int low, int high);
+int hmm_get_adaptive_threshold(int segment_size);
+int hmm_median_of_five_index(const int arr[], int i1, int i2, int i3, int i4, int i5);
+int hmm_median_of_three_index(const int arr[], int i1, int i2, int i3);
+int hmm_select_lower_pivot(const int arr[], int left, int right, int segment_size);
+int hmm_select_upper_pivot(const int arr[], int left, int right, int segment_size);
+void hmm_merge(int arr[], int left, int mid, int right);
+void hmm_merge_sort(int arr[], int left, int right);
+void hmm_partition_by_pivots(int arr[], int left, int right, int lowerPivot, int upperPivot,
+                         int *out_l, int *out_r);
+void hmm_partition_min_max(int arr[], int left, int right, int *out_l, int *out_r);
+int hmm_prescan_min_max(const int arr[], int left, int right, int *out_min, int *out_max);
+void hmm_counting_sort_range(int arr[], int left, int right, int min_value, int max_value);
 void hybrid_min_max_sort_serial(int arr[], int left, int right, int k);
+void hybrid_min_max_sort_seeded(int arr[], int left, int right, unsigned long long seed);
+void hybrid_min_max_sort_copy(const int src[], int dst[], int n);
+void hmm_append_sorted(int arr[], int sorted_len, int total_len);
+
+/* --- Общие части драйверов с явным стеком сегментов --- */
+int hmm_depth_limit(size_t n);
+void hmm_nudge_pivots(int *lowerPivot, int *upperPivot, int min_value, int max_value);
+void hmm_part_order(const int lo[3], const int hi[3], int order[3]);
+
+/* --- Сортировка с удалением дубликатов и подсчётом по ключам (int) --- */
+int hybrid_min_max_sort_unique(int arr[], int n);
+int hybrid_min_max_sort_count(int arr[], int n, int keys_out[], int counts_out[]);
+
+/* --- Разбиение на корзины по диапазонам значений без сортировки (int) --- */
+void hybrid_min_max_partition(int arr[], int n, const int splitters[], int bucket_count,
+                              int offsets[], int threads);
+
+/* --- Лексикографическая сортировка по нескольким столбцам --- */
+enum {
+    HMM_COLUMN_INT64,     // data – const int64_t[]
+    HMM_COLUMN_DOUBLE,    // data – const double[]; порядок по битам IEEE: -0 и +0 не
+                          // равны (-0 раньше), NaN с минусом в начале, прочие в конце
+    HMM_COLUMN_DICT       // data – const int[] кодов словаря
+};
+
+typedef struct {
+    int type;
+    const void *data;
+    const int *dict_rank;   // для словаря: ранг кода в порядке значений (NULL – порядок кодов)
+    int descending;
+} hmm_column;
+
+void hmm_sort_columns(const hmm_column cols[], int ncols, int n, int perm_out[]);
 
 /* --- Прототипы функций для double --- */
-void insertion_sort_double(double arr[], int low, int high);
-int median_of_five_index_double(const double arr[], int i1, int i2, int i3, int i4, int i5);
-int median_of_three_index_double(const double arr[], int i1, int i2, int i3);
-int select_lower_pivot_double(const double arr[], int left, int right, int segment_size);
-int select_upper_pivot_double(const double arr[], int left, int right, int segment_size);
-void merge_double(double arr[], int left, int mid, int right);
-void merge_sort_double(double arr[], int left, int right);
+void hmm_insertion_sort_double(double arr[], int low, int high);
+int hmm_get_adaptive_threshold_double(int segment_size);
+int hmm_median_of_five_index_double(const double arr[], int i1, int i2, int i3, int i4, int i5);
+int hmm_median_of_three_index_double(const double arr[], int i1, int i2, int i3);
+int hmm_select_lower_pivot_double(const double arr[], int left, int right, int segment_size);
+int hmm_select_upper_pivot_double(const double arr[], int left, int right, int segment_size);
+void hmm_merge_double(double arr[], int left, int mid, int right);
+void hmm_merge_sort_double(double arr[], int left, int right);
+void hmm_partition_min_max_double(double arr[], int left, int right, int *out_l, int *out_r);
 void hybrid_min_max_sort_serial_double(double arr[], int left, int right, int k);
+void hmm_append_sorted_double(double arr[], int sorted_len, int total_len);
+
+/* --- Полный порядок для float/double: NaN в конце, -0 перед +0 --- */
+void hybrid_min_max_sort_total_double(double arr[], int n);
+void hybrid_min_max_sort_total_float(float arr[], int n);
+
+/* --- Режим пропускной способности для очень больших массивов (int) --- */
+void *hmm_huge_alloc(size_t bytes, size_t *mapped);
+void hmm_huge_free(void *p, size_t mapped);
+void hmm_merge_sort_large(int arr[], int n);
+void hybrid_min_max_sort_large(int arr[], int n);
+
+/* --- Кооперативная сортировка с ограничением времени шага (int) --- */
+#define HMM_TASK_STACK_SIZE 64
+
+typedef struct {
+    int *arr;
+    int n;
+    int phase;
+    int left, right;                        // текущий сегмент
+    int min_value, max_value, depth;        // границы значений и глубина текущего сегмента
+    int stack_left[HMM_TASK_STACK_SIZE];    // отложенные сегменты
+    int stack_right[HMM_TASK_STACK_SIZE];
+    int stack_min[HMM_TASK_STACK_SIZE];
+    int stack_max[HMM_TASK_STACK_SIZE];
+    int stack_depth[HMM_TASK_STACK_SIZE];
+    int top;
+    int max_depth;
+    int i, l, r, lower, upper;              // состояние предпросмотра и разбиения
+    int *buf;                               // состояние запасной сортировки слиянием
+    int width, pos, merging;                // (и подсчёта: buf – гистограмма)
+    int mi, mn1, mj, mk, mend;
+    long long work_done, work_estimate;     // для оценки прогресса
+    long long done_elems;                   // элементов в окончательно отсортированных сегментах
+    int cancelled;
+} hmm_sort_task;
+
+void hmm_sort_task_init(hmm_sort_task *task, int arr[], int n);
+int hmm_sort_task_step(hmm_sort_task *task, long long budget_ns);
+void hmm_sort_task_cancel(hmm_sort_task *task);
+double hmm_sort_task_progress(const hmm_sort_task *task);
+
+/* --- Ленивый отсортированный итератор (int) --- */
+#define HMM_LAZY_STACK_SIZE 128
+
+typedef struct {
+    int *arr;
+    int n;
+    int next;                               // первый ещё не выданный элемент
+    int ready;                              // arr[0..ready-1] на окончательных местах
+    int stack_left[HMM_LAZY_STACK_SIZE];    // отложенные сегменты, самый левый сверху
+    int stack_right[HMM_LAZY_STACK_SIZE];
+    int stack_min[HMM_LAZY_STACK_SIZE];     // границы значений сегментов
+    int stack_max[HMM_LAZY_STACK_SIZE];
+    int stack_depth[HMM_LAZY_STACK_SIZE];
+    int top;
+    int max_depth;
+} hmm_lazy_iter;
+
+void hmm_lazy_iter_init(hmm_lazy_iter *it, int arr[], int n);
+int hmm_lazy_iter_next(hmm_lazy_iter *it, int *out);
+int hmm_lazy_iter_page(hmm_lazy_iter *it, int max, const int **page);
+
+/* --- Распределённая сортировка выборкой --- */
+typedef struct hmm_transport {
+    int rank;
+    int size;
+    void *ctx;
+    // Сбор блоков по count элементов со всех рангов в recv[size * count]
+    int (*allgather)(struct hmm_transport *t, const int *send, int count, int *recv);
+    // Обмен "все со всеми": send упорядочен по рангам-получателям; принятые серии
+    // кладутся подряд в *recv (malloc), их длины – в recv_counts[size]
+    int (*alltoallv)(struct hmm_transport *t, const int *send, const int send_counts[],
+                     int **recv, int recv_counts[]);
+} hmm_transport;
+
+int hmm_dist_sort(hmm_transport *t, int local[], int n_local, int **out, int *out_n);
+int hmm_dist_sort_local(int arr[], int n, int ranks);
+
+/* --- Совместимая с qsort точка входа --- */
+typedef int (*hmm_cmp_fn)(const void *, const void *);
+
+void hmm_qsort(void *base, size_t n, size_t size, hmm_cmp_fn cmp);
+
+/* --- k-путевое слияние отсортированных серий (дерево проигравших) --- */
+typedef struct {
+    void *ctx;
+    // Следующие не более cap элементов серии в buf; 0 – серия закончилась, < 0 – ошибка
+    int (*read)(void *ctx, int *buf, int cap);
+} hmm_run_reader;
+
+// Приём очередного блока результата; ненулевой код прерывает слияние
+typedef int (*hmm_run_writer)(void *ctx, const int *buf, int n);
+
+void hmm_kmerge(const int *runs[], const int lens[], int k, int out[]);
+void hmm_kmerge_generic(const void *runs[], const int lens[], int k, size_t size,
+                        hmm_cmp_fn cmp, void *out);
+void hmm_kmerge_parallel(const int *runs[], const int lens[], int k, int out[], int threads);
+long long hmm_kmerge_stream(hmm_run_reader readers[], int k, hmm_run_writer write, void *write_ctx);
+
+/* --- Генераторы входных распределений для тестов и замеров --- */
+enum {
+    HMM_PATTERN_RANDOM,
+    HMM_PATTERN_SORTED,
+    HMM_PATTERN_REVERSE,
+    HMM_PATTERN_ORGAN_PIPE,
+    HMM_PATTERN_SAWTOOTH,
+    HMM_PATTERN_ALL_EQUAL,
+    HMM_PATTERN_FEW_UNIQUE,
+    HMM_PATTERN_MEDIAN3_KILLER,
+    HMM_PATTERN_PIVOT_KILLER,
+    HMM_PATTERN_COUNT
+};
+
+void hmm_generate_pattern(int arr[], int n, int kind, unsigned long long seed);
+
+/* --- Трассировка в формате Chrome trace (события пишутся при сборке с -DHMM_TRACE) --- */
+enum { HMM_TRACE_PART_LOW, HMM_TRACE_PART_MID, HMM_TRACE_PART_HIGH, HMM_TRACE_PART_ROOT };
+enum {
+    HMM_TRACE_INSERTION,
+    HMM_TRACE_COUNTING,
+    HMM_TRACE_PARTITION,
+    HMM_TRACE_MERGE,
+    HMM_TRACE_HISTOGRAM,    // этапы параллельной сортировки
+    HMM_TRACE_SCATTER,
+    HMM_TRACE_BUCKET
+};
+
+// Минимальный размер записываемого сегмента; HMM_TRACE_THRESHOLD читается
+// при первом событии трассировки и заменяет значение, заданное до него
+extern int hmm_trace_threshold;
+
+long long hmm_trace_now(void);
+long long hmm_trace_begin(int size);
+void hmm_trace_record(long long begin_ns, int size, int lower, int upper, int part, int kernel);
+void hmm_trace_reset(void);
+int hmm_trace_dump(const char *path);
+
+#ifdef HMM_TRACE
+#define HMM_TRACE_ONLY(x) x
+#define HMM_TRACE_BEGIN(size) long long hmm_trace_t0 = hmm_trace_begin(size)
+#define HMM_TRACE_END(size, lower, upper, part, kernel)                                  \
+    do {                                                                                 \
+        if (hmm_trace_t0)                                                                \
+            hmm_trace_record(hmm_trace_t0, (size), (lower), (upper), (part), (kernel));  \
+    } while (0)
+#else
+#define HMM_TRACE_ONLY(x)
+#define HMM_TRACE_BEGIN(size) ((void)0)
+#define HMM_TRACE_END(size, lower, upper, part, kernel) ((void)0)
+#endif
+
+/* --- Параллельная сортировка с учётом NUMA (Linux, -pthread) --- */
+#define HMM_MAX_NUMA_NODES 16
+#define HMM_MAX_NODE_CPUS 128
+
+typedef struct {
+    int node_count;
+    int cpu_count[HMM_MAX_NUMA_NODES];
+    int cpus[HMM_MAX_NUMA_NODES][HMM_MAX_NODE_CPUS];
+} hmm_numa_topology;
+
+int hmm_numa_parse_cpulist(const char *s, int out[], int max);
+int hmm_numa_detect(hmm_numa_topology *topo);
+void hybrid_min_max_sort_numa(int arr[], int n, int threads, const hmm_numa_topology *topo);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* MIN_MAX_SORT_H */
 
@@ -0,0 +1,57 @@
+/*
+ * min_max_sort.hpp
+ *
+ * C++-интерфейс гибридной сортировки Min-Max (пространство имён hmm):
+ * реализация на std::vector из min_max_sort.cpp и тонкие обёртки над
+ * C-библиотекой для векторов.
+ */
+
+#ifndef MIN_MAX_SORT_HPP
+#define MIN_MAX_SORT_HPP
+
+#include <vector>
+#include "min_max_sort.h"
+
+namespace hmm {
+
+/* --- Реализация на std::vector (int) --- */
+void insertion_sort(std::vector<int>& arr, int low, int high);
+int get_adaptive_threshold(int segment_size);
+int median_of_five_index(const std::vector<int>& arr, int i1, int i2, int i3, int i4, int i5);
+int median_of_three_index(const std::vector<int>& arr, int i1, int i2, int i3);
+int select_lower_pivot(const std::vector<int>& arr, int left, int right, int segment_size);
+int select_upper_pivot(const std::vector<int>& arr, int left, int right, int segment_size);
+void merge(std::vector<int>& arr, int left, int mid, int right);
+void merge_sort(std::vector<int>& arr, int left, int right);
+void hybrid_min_max_sort(std::vector<int>& arr, int left, int right, int k);
+
+/* --- Обёртки над C-библиотекой --- */
+
+// Сортировка всего вектора
+inline void sort(std::vector<int>& v) {
+    if (v.size() > 1)
+        hybrid_min_max_sort_serial(v.data(), 0, static_cast<int>(v.size()) - 1, 2);
+}
+
+inline void sort(std::vector<double>& v) {
+    if (v.size() > 1)
+        hybrid_min_max_sort_serial_double(v.data(), 0, static_cast<int>(v.size()) - 1, 2);
+}
+
+// Полный порядок: NaN в конце, -0 перед +0
+inline void sort_total(std::vector<double>& v) {
+    hybrid_min_max_sort_total_double(v.data(), static_cast<int>(v.size()));
+}
+
+inline void sort_total(std::vector<float>& v) {
+    hybrid_min_max_sort_total_float(v.data(), static_cast<int>(v.size()));
+}
+
+// Сортировка с удалением дубликатов; вектор укорачивается до различных значений
+inline void sort_unique(std::vector<int>& v) {
+    v.resize(hybrid_min_max_sort_unique(v.data(), static_cast<int>(v.size())));
+}
+
+} // namespace hmm
+
+#endif /* MIN_MAX_SORT_HPP */
@@ -0,0 +1,267 @@
+/*
+ * min_max_sort_columns.c
+ *
+ * Лексикографическая сортировка строк столбцовой таблицы по нескольким
+ * столбцам (int64, double, словарные коды). Сортируется перестановка номеров
+ * строк: сначала по первому столбцу, затем только диапазоны равных ключей –
+ * по следующему и т. д. Ключи столбца переводятся в беззнаковые 64-битные
+ * с тем же порядком, а диапазоны равенства берутся прямо из разбиения:
+ * сегмент из одного значения (в том числе средняя часть при равных опорных)
+ * целиком становится диапазоном, листья просматриваются на серии.
+ */
+
+#include "min_max_sort.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COLUMNS_STACK_SIZE 64
+
+typedef struct {
+    uint64_t key;
+    int row;
+} key_row;
+
+// Найденные диапазоны равных ключей [lo, hi] (включительно)
+typedef struct {
+    int *lo, *hi;
+    int count, capacity;
+} tie_list;
+
+static void tie_add(tie_list *t, int lo, int hi) {
+    if (t->count == t->capacity) {
+        int capacity = t->capacity ? 2 * t->capacity : 256;
+        int *nlo = realloc(t->lo, capacity * sizeof(int));
+        int *nhi = nlo ? realloc(t->hi, capacity * sizeof(int)) : NULL;
+        if (!nlo || !nhi) {
+            fprintf(stderr, "Ошибка выделения памяти в hmm_sort_columns.\n");
+            exit(EXIT_FAILURE);
+        }
+        t->lo = nlo;
+        t->hi = nhi;
+        t->capacity = capacity;
+    }
+    t->lo[t->count] = lo;
+    t->hi[t->count++] = hi;
+}
+
+// Ключ строки row столбца col: беззнаковое число с тем же порядком.
+// int64 – инверсия знакового бита; double – для отрицательных инверсия всех
+// битов, для остальных – знакового; словарь – ранг кода (или сам код)
+static inline uint64_t column_key(const hmm_column *col, int row) {
+    uint64_t key;
+    if (col->type == HMM_COLUMN_INT64) {
+        key = (uint64_t)((const int64_t *)col->data)[row] ^ 0x8000000000000000ULL;
+    } else if (col->type == HMM_COLUMN_DOUBLE) {
+        uint64_t bits;
+        memcpy(&bits, (const double *)col->data + row, sizeof(bits));
+        key = (bits & 0x8000000000000000ULL) ? ~bits : bits ^ 0x8000000000000000ULL;
+    } else {
+        int code = ((const int *)col->data)[row];
+        key = (uint64_t)(uint32_t)(col->dict_rank ? col->dict_rank[code] : code);
+    }
+    return col->descending ? ~key : key;
+}
+
+// Выдача серий равных ключей отсортированного a[left..right] в список
+static void tie_scan(const key_row a[], int left, int right, tie_list *ties) {
+    for (int i = left; i < right;) {
+        int j = i + 1;
+        while (j <= right && a[j].key == a[i].key)
+            j++;
+        if (j - i > 1)
+            tie_add(ties, i, j - 1);
+        i = j;
+    }
+}
+
+static void key_row_insertion_sort(key_row a[], int left, int right) {
+    for (int i = left + 1; i <= right; i++) {
+        key_row x = a[i];
+        int j = i - 1;
+        while (j >= left && a[j].key > x.key) {
+            a[j + 1] = a[j];
+            j--;
+        }
+        a[j + 1] = x;
+    }
+}
+
+// Сортировка слиянием снизу вверх для запасного пути
+static void key_row_merge_sort(key_row a[], int left, int right, key_row tmp[]) {
+    int n = right - left + 1;
+    for (int width = 1; width < n; width *= 2) {
+        for (int lo = left; lo + width <= right; lo += 2 * width) {
+            int mid = lo + width, hi = (lo + 2 * width - 1 < right) ? lo + 2 * width - 1 : right;
+            int i = lo, j = mid, k = 0;
+            while (i < mid && j <= hi)
+                tmp[k++] = (a[j].key < a[i].key) ? a[j++] : a[i++];
+            while (i < mid)
+                tmp[k++] = a[i++];
+            while (j <= hi)
+                tmp[k++] = a[j++];
+            memcpy(a + lo, tmp, k * sizeof(key_row));
+        }
+    }
+}
+
+static inline uint64_t median3_key(uint64_t a, uint64_t b, uint64_t c) {
+    if (a > b) {
+        uint64_t t = a;
+        a = b;
+        b = t;
+    }
+    if (b > c)
+        b = c;
+    return (a > b) ? a : b;
+}
+
+// Гибридная сортировка пар (ключ, строка) с ведением границ значений, как в
+// hybrid_min_max_sort_serial: тот же порог вставок из профиля, предел глубины
+// hmm_depth_limit и порядок частей hmm_part_order; ключи 64-битные, поэтому
+// выбор и сдвиг опорных – свои. Попутно собирает диапазоны равных ключей
+static void key_row_sort(key_row a[], int left, int right, key_row tmp[], tie_list *ties) {
+    int stack_left[COLUMNS_STACK_SIZE], stack_right[COLUMNS_STACK_SIZE];
+    uint64_t stack_min[COLUMNS_STACK_SIZE], stack_max[COLUMNS_STACK_SIZE];
+    int stack_depth[COLUMNS_STACK_SIZE];
+    int top = 0, depth = 0;
+    if (right <= left)
+        return;
+    uint64_t min_key = a[left].key, max_key = a[left].key;
+    for (int i = left + 1; i <= right; i++) {
+        min_key = (a[i].key < min_key) ? a[i].key : min_key;
+        max_key = (a[i].key > max_key) ? a[i].key : max_key;
+    }
+    int max_depth = hmm_depth_limit(right - left + 1);
+
+    for (;;) {
+        int segment_size = right - left + 1;
+        if (segment_size <= 1) {
+            // Ни сортировать, ни уточнять нечего
+        } else if (min_key == max_key) {
+            tie_add(ties, left, right);
+        } else if (segment_size <= hmm_get_adaptive_threshold(segment_size)) {
+            key_row_insertion_sort(a, left, right);
+            tie_scan(a, left, right, ties);
+        } else if (depth >= max_depth) {
+            key_row_merge_sort(a, left, right, tmp);
+            tie_scan(a, left, right, ties);
+        } else {
+            int s = segment_size / 8;
+            uint64_t lowerPivot = median3_key(a[left + s].key, a[left + 2 * s].key, a[left + 3 * s].key);
+            uint64_t upperPivot = median3_key(a[left + 5 * s].key, a[left + 6 * s].key, a[left + 7 * s].key);
+            if (lowerPivot > upperPivot) {
+                uint64_t t = lowerPivot;
+                lowerPivot = upperPivot;
+                upperPivot = t;
+            }
+            // Сдвиг опорных с границ, как в hmm_nudge_pivots
+            int upper_nudged = 0;
+            if (lowerPivot == min_key)
+                lowerPivot++;
+            if (upperPivot == max_key) {
+                upperPivot--;
+                upper_nudged = 1;
+            }
+            if (upperPivot < lowerPivot) {
+                if (upper_nudged)
+                    lowerPivot = upperPivot;
+                else
+                    upperPivot = lowerPivot;
+            }
+            int l = left, r = right;
+            for (int i = left; i <= r;) {
+                if (a[i].key < lowerPivot) {
+                    key_row t = a[i];
+                    a[i++] = a[l];
+                    a[l++] = t;
+                } else if (a[i].key > upperPivot) {
+                    key_row t = a[i];
+                    a[i] = a[r];
+                    a[r--] = t;
+                } else {
+                    i++;
+                }
+            }
+            if (l == left || r == right) {
+                key_row_merge_sort(a, left, right, tmp);
+                tie_scan(a, left, right, ties);
+            } else {
+                int lo[3] = { left, l, r + 1 }, hi[3] = { l - 1, r, right };
+                uint64_t vmin[3] = { min_key, lowerPivot, upperPivot + 1 };
+                uint64_t vmax[3] = { lowerPivot - 1, upperPivot, max_key };
+                int order[3];
+                hmm_part_order(lo, hi, order);
+                for (int q = 0; q < 2; q++) {
+                    int p = order[q];
+                    stack_left[top] = lo[p];
+                    stack_right[top] = hi[p];
+                    stack_min[top] = vmin[p];
+                    stack_max[top] = vmax[p];
+                    stack_depth[top++] = depth + 1;
+                }
+                int small = order[2];
+                left = lo[small];
+                right = hi[small];
+                min_key = vmin[small];
+                max_key = vmax[small];
+                depth++;
+                continue;
+            }
+        }
+        if (top == 0)
+            break;
+        top--;
+        left = stack_left[top];
+        right = stack_right[top];
+        min_key = stack_min[top];
+        max_key = stack_max[top];
+        depth = stack_depth[top];
+    }
+}
+
+// Лексикографическая сортировка n строк по столбцам cols[0..ncols-1]:
+// perm_out[i] – номер i-й строки в отсортированном порядке. Строки, равные
+// по всем столбцам, остаются в порядке номеров (сортировка устойчива)
+void hmm_sort_columns(const hmm_column cols[], int ncols, int n, int perm_out[]) {
+    hmm_tuning_init();
+    for (int i = 0; i < n; i++)
+        perm_out[i] = i;
+    if (n < 2)
+        return;
+    key_row *pairs = malloc((size_t)n * sizeof(key_row));
+    key_row *tmp = malloc((size_t)n * sizeof(key_row));
+    if (!pairs || !tmp) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_sort_columns.\n");
+        exit(EXIT_FAILURE);
+    }
+    // Диапазоны perm_out, ещё не упорядоченные предыдущими столбцами
+    tie_list ranges = { 0 }, next = { 0 };
+    tie_add(&ranges, 0, n - 1);
+    for (int c = 0; c < ncols && ranges.count > 0; c++) {
+        next.count = 0;
+        for (int t = 0; t < ranges.count; t++) {
+            int lo = ranges.lo[t], hi = ranges.hi[t];
+            for (int i = lo; i <= hi; i++) {
+                pairs[i].key = column_key(&cols[c], perm_out[i]);
+                pairs[i].row = perm_out[i];
+            }
+            key_row_sort(pairs, lo, hi, tmp, &next);
+            for (int i = lo; i <= hi; i++)
+                perm_out[i] = pairs[i].row;
+        }
+        tie_list swap = ranges;
+        ranges = next;
+        next = swap;
+    }
+    // Равные по всем столбцам строки – по возрастанию номера
+    for (int t = 0; t < ranges.count; t++)
+        hybrid_min_max_sort_serial(perm_out, ranges.lo[t], ranges.hi[t], 2);
+    free(ranges.lo);
+    free(ranges.hi);
+    free(next.lo);
+    free(next.hi);
+    free(tmp);
+    free(pairs);
+}
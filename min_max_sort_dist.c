@@ -0,0 +1,281 @@
+/*
+ * min_max_sort_dist.c
+ *
+ * Распределённая сортировка выборкой поверх гибридной сортировки Min-Max:
+ * каждый ранг сортирует свою часть, ранги согласуют разделители по выборкам,
+ * обмениваются данными "все со всеми" и сливают полученные отсортированные
+ * серии. Транспорт подключаемый (hmm_transport); локальная реализация
+ * запускает ранги отдельными процессами (fork) с обменом через общую память.
+ */
+
+#define _GNU_SOURCE
+#include "min_max_sort.h"
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define DIST_SAMPLES_PER_RANK 64
+
+/* ==================== Алгоритм ==================== */
+
+// Число элементов отсортированного a[0..n-1], не превосходящих key
+static int count_not_greater(const int a[], int n, int key) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (a[mid] <= key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Сортировка распределённых данных: local[0..n_local-1] – часть данных этого ранга.
+// Результат – отсортированный диапазон значений ранга в *out (malloc), длина в *out_n;
+// диапазоны рангов по возрастанию номера образуют отсортированную последовательность
+int hmm_dist_sort(hmm_transport *t, int local[], int n_local, int **out, int *out_n) {
+    int P = t->size, status = -1;
+    if (n_local > 1)
+        hybrid_min_max_sort_serial(local, 0, n_local - 1, 2);
+
+    // Регулярная выборка: первый элемент блока – число действительных образцов
+    int s = DIST_SAMPLES_PER_RANK;
+    int *send = malloc((s + 1) * sizeof(int));
+    int *all = malloc((size_t)P * (s + 1) * sizeof(int));
+    int *splitters = malloc((P > 1 ? P - 1 : 1) * sizeof(int));
+    int *send_counts = malloc(P * sizeof(int));
+    int *recv_counts = malloc(P * sizeof(int));
+    if (!send || !all || !splitters || !send_counts || !recv_counts) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_dist_sort.\n");
+        exit(EXIT_FAILURE);
+    }
+    int valid = (n_local < s) ? n_local : s;
+    send[0] = valid;
+    for (int i = 0; i < valid; i++)
+        send[i + 1] = local[(int)((long long)n_local * (2 * i + 1) / (2 * valid))];
+    if (t->allgather(t, send, s + 1, all) != 0)
+        goto cleanup;
+
+    int total = 0;
+    for (int r = 0; r < P; r++) {
+        int c = all[r * (s + 1)];
+        memmove(&all[total], &all[r * (s + 1) + 1], c * sizeof(int));
+        total += c;
+    }
+    if (total > 1)
+        hybrid_min_max_sort_serial(all, 0, total - 1, 2);
+    for (int b = 0; b < P - 1; b++)
+        splitters[b] = total > 0 ? all[(int)((long long)total * (b + 1) / P)] : INT_MAX;
+
+    // Локальные данные уже отсортированы, поэтому части для рангов идут подряд
+    int prev = 0;
+    for (int b = 0; b < P; b++) {
+        int end = (b < P - 1) ? count_not_greater(local, n_local, splitters[b]) : n_local;
+        send_counts[b] = end - prev;
+        prev = end;
+    }
+
+    int *recv = NULL;
+    if (t->alltoallv(t, local, send_counts, &recv, recv_counts) != 0)
+        goto cleanup;
+
+    // Полученные серии отсортированы – остаётся k-путевое слияние деревом проигравших
+    const int **runs = malloc(P * sizeof(int *));
+    int n_recv = 0;
+    for (int r = 0; r < P; r++)
+        n_recv += recv_counts[r];
+    int *result = malloc((n_recv > 0 ? n_recv : 1) * sizeof(int));
+    if (!runs || !result) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_dist_sort.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int r = 0, off = 0; r < P; r++) {
+        runs[r] = recv + off;
+        off += recv_counts[r];
+    }
+    hmm_kmerge(runs, recv_counts, P, result);
+    free(runs);
+    free(recv);
+    *out = result;
+    *out_n = n_recv;
+    status = 0;
+
+    // Единственный выход: буферы обмена освобождаются и при ошибке транспорта
+cleanup:
+    free(recv_counts);
+    free(send_counts);
+    free(splitters);
+    free(all);
+    free(send);
+    return status;
+}
+
+/* ==================== Локальный транспорт: процессы и общая память ==================== */
+
+typedef struct {
+    pthread_barrier_t barrier;
+    int ranks;
+    int n;
+    int gather_count;
+    // Далее в той же области: gather[ranks * gather_count], counts[ranks * ranks],
+    // входные данные data[n] (часть ранга r – его буфер отправки), выход out[n]
+} shm_header;
+
+typedef struct {
+    shm_header *hdr;
+    int *gather;
+    int *counts;
+    int *data;
+    int *out;
+} shm_ctx;
+
+// Начало части ранга r во входных данных
+static int slice_begin(int n, int ranks, int r) {
+    return (int)((long long)n * r / ranks);
+}
+
+static int shm_allgather(hmm_transport *t, const int *send, int count, int *recv) {
+    shm_ctx *c = t->ctx;
+    if (count > c->hdr->gather_count)
+        return -1;
+    memcpy(&c->gather[t->rank * count], send, count * sizeof(int));
+    pthread_barrier_wait(&c->hdr->barrier);
+    memcpy(recv, c->gather, (size_t)t->size * count * sizeof(int));
+    pthread_barrier_wait(&c->hdr->barrier);
+    return 0;
+}
+
+// Буфер отправки ранга должен лежать в общей области (это его часть входа)
+static int shm_alltoallv(hmm_transport *t, const int *send, const int send_counts[],
+                         int **recv, int recv_counts[]) {
+    shm_ctx *c = t->ctx;
+    int P = t->size, me = t->rank;
+    if (send != &c->data[slice_begin(c->hdr->n, P, me)])
+        return -1;
+    memcpy(&c->counts[me * P], send_counts, P * sizeof(int));
+    pthread_barrier_wait(&c->hdr->barrier);
+
+    int total = 0;
+    for (int s = 0; s < P; s++) {
+        recv_counts[s] = c->counts[s * P + me];
+        total += recv_counts[s];
+    }
+    int *buf = malloc((total > 0 ? total : 1) * sizeof(int));
+    if (!buf)
+        return -1;
+    for (int s = 0, off = 0; s < P; s++) {
+        int from = slice_begin(c->hdr->n, P, s);
+        for (int d = 0; d < me; d++)
+            from += c->counts[s * P + d];
+        memcpy(&buf[off], &c->data[from], recv_counts[s] * sizeof(int));
+        off += recv_counts[s];
+    }
+    pthread_barrier_wait(&c->hdr->barrier);
+    *recv = buf;
+    return 0;
+}
+
+// Работа одного ранга в дочернем процессе
+static int local_rank_main(shm_ctx *c, int rank) {
+    int P = c->hdr->ranks, n = c->hdr->n;
+    hmm_transport t = { rank, P, c, shm_allgather, shm_alltoallv };
+    int begin = slice_begin(n, P, rank);
+    int *result;
+    int n_result;
+    if (hmm_dist_sort(&t, &c->data[begin], slice_begin(n, P, rank + 1) - begin, &result, &n_result) != 0)
+        return -1;
+
+    // Позиция результата: сумма полученного рангами с меньшими номерами
+    int offset = 0;
+    for (int d = 0; d < rank; d++)
+        for (int s = 0; s < P; s++)
+            offset += c->counts[s * P + d];
+    memcpy(&c->out[offset], result, n_result * sizeof(int));
+    free(result);
+    return 0;
+}
+
+// Распределённая сортировка arr[0..n-1] на ranks процессах этой машины.
+// Возвращает 0 при успехе, -1 при ошибке (массив тогда не изменяется)
+int hmm_dist_sort_local(int arr[], int n, int ranks) {
+    if (ranks < 1)
+        return -1;
+    int gather_count = DIST_SAMPLES_PER_RANK + 1;
+    size_t ints = (size_t)ranks * gather_count + (size_t)ranks * ranks + 2 * (size_t)n;
+    size_t bytes = sizeof(shm_header) + ints * sizeof(int);
+    shm_header *hdr = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (hdr == MAP_FAILED)
+        return -1;
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&hdr->barrier, &attr, ranks);
+    pthread_barrierattr_destroy(&attr);
+    hdr->ranks = ranks;
+    hdr->n = n;
+    hdr->gather_count = gather_count;
+
+    shm_ctx c;
+    c.hdr = hdr;
+    c.gather = (int *)(hdr + 1);
+    c.counts = c.gather + (size_t)ranks * gather_count;
+    c.data = c.counts + (size_t)ranks * ranks;
+    c.out = c.data + n;
+    memcpy(c.data, arr, n * sizeof(int));
+
+    pid_t *pids = malloc(ranks * sizeof(pid_t));
+    if (!pids) {
+        munmap(hdr, bytes);
+        return -1;
+    }
+    int started = 0;
+    for (; started < ranks; started++) {
+        pid_t pid = fork();
+        if (pid < 0)
+            break;
+        if (pid == 0)
+            _exit(local_rank_main(&c, started) == 0 ? 0 : 1);
+        pids[started] = pid;
+    }
+    // Если ранг не запустился или завершился с ошибкой, остальные не пройдут
+    // барьер – их нужно остановить
+    int ok = started == ranks;
+    if (!ok)
+        for (int r = 0; r < started; r++)
+            kill(pids[r], SIGKILL);
+    // Опрос только своих процессов: у вызывающей программы могут быть другие дочерние
+    for (int left = started; left > 0;) {
+        int reaped = 0;
+        for (int r = 0; r < started; r++) {
+            int status;
+            if (pids[r] <= 0 || waitpid(pids[r], &status, WNOHANG) <= 0)
+                continue;
+            if ((!WIFEXITED(status) || WEXITSTATUS(status) != 0) && ok) {
+                ok = 0;
+                for (int q = 0; q < started; q++)
+                    if (q != r && pids[q] > 0)
+                        kill(pids[q], SIGKILL);
+            }
+            pids[r] = 0;
+            left--;
+            reaped = 1;
+        }
+        if (!reaped)
+            usleep(1000);
+    }
+    if (ok)
+        memcpy(arr, c.out, n * sizeof(int));
+
+    pthread_barrier_destroy(&hdr->barrier);
+    free(pids);
+    munmap(hdr, bytes);
+    return ok ? 0 : -1;
+}
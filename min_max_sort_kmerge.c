@@ -0,0 +1,357 @@
+/*
+ * min_max_sort_kmerge.c
+ *
+ * k-путевое слияние отсортированных серий через дерево проигравших
+ * (турнирное дерево): в узлах хранятся номера проигравших серий, победитель
+ * поднимается от листа к корню за log2 k сравнений без ветвлений. Варианты:
+ * серии в памяти (int и произвольные элементы с компаратором), параллельное
+ * слияние с разбиением выхода поиском разделителей и потоковые читатели.
+ */
+
+#include "min_max_sort.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KMERGE_EXHAUSTED LLONG_MAX     // ключ исчерпанной серии больше любого int
+#define KMERGE_STREAM_BUF 1024         // элементов в буфере потоковой серии
+
+/* ==================== Дерево проигравших ==================== */
+
+// Дерево на kp листьях (kp – степень двойки): tree[1..kp-1] – проигравшие
+// в узлах, tree[0] – победитель. Головы серий лежат в key[0..kp-1]
+typedef struct {
+    int kp;
+    int *tree;
+    long long *key;
+} loser_tree;
+
+static void loser_tree_init(loser_tree *lt, int k) {
+    int kp = 1;
+    while (kp < k)
+        kp <<= 1;
+    lt->kp = kp;
+    lt->tree = malloc((size_t)kp * sizeof(int));
+    lt->key = malloc((size_t)kp * sizeof(long long));
+    if (!lt->tree || !lt->key) {
+        fprintf(stderr, "Ошибка выделения памяти в loser_tree_init.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int r = 0; r < kp; r++)
+        lt->key[r] = KMERGE_EXHAUSTED;
+}
+
+// Начальный турнир по заполненным key: победители узлов собираются снизу
+// вверх во временном массиве, проигравшие остаются в tree
+static void loser_tree_build(loser_tree *lt) {
+    int kp = lt->kp;
+    int *node_win = malloc(2 * (size_t)kp * sizeof(int));
+    if (!node_win) {
+        fprintf(stderr, "Ошибка выделения памяти в loser_tree_build.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int r = 0; r < kp; r++)
+        node_win[kp + r] = r;
+    for (int node = kp - 1; node > 0; node--) {
+        int a = node_win[2 * node], b = node_win[2 * node + 1];
+        int a_wins = lt->key[a] <= lt->key[b];
+        node_win[node] = a_wins ? a : b;
+        lt->tree[node] = a_wins ? b : a;
+    }
+    lt->tree[0] = node_win[1];
+    free(node_win);
+}
+
+// Новая голова серии r (она была победителем): подъём от листа к корню.
+// Условные присваивания компилируются в cmov, ветвлений в цикле нет
+static inline void loser_tree_replay(loser_tree *lt, int r) {
+    int winner = r;
+    long long wkey = lt->key[r];
+    for (int node = (r + lt->kp) >> 1; node > 0; node >>= 1) {
+        int other = lt->tree[node];
+        long long okey = lt->key[other];
+        int swap = okey < wkey;
+        lt->tree[node] = swap ? winner : other;
+        winner = swap ? other : winner;
+        wkey = swap ? okey : wkey;
+    }
+    lt->tree[0] = winner;
+}
+
+static void loser_tree_free(loser_tree *lt) {
+    free(lt->tree);
+    free(lt->key);
+}
+
+/* ==================== Серии в памяти ==================== */
+
+// Слияние k отсортированных серий runs[r][0..lens[r]-1] в out
+void hmm_kmerge(const int *runs[], const int lens[], int k, int out[]) {
+    if (k <= 0)
+        return;
+    if (k == 1) {
+        memcpy(out, runs[0], (size_t)lens[0] * sizeof(int));
+        return;
+    }
+    loser_tree lt;
+    loser_tree_init(&lt, k);
+    int *pos = calloc((size_t)k, sizeof(int));
+    if (!pos) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_kmerge.\n");
+        exit(EXIT_FAILURE);
+    }
+    long long total = 0;
+    for (int r = 0; r < k; r++) {
+        if (lens[r] > 0)
+            lt.key[r] = runs[r][0];
+        total += lens[r];
+    }
+    loser_tree_build(&lt);
+    for (long long o = 0; o < total; o++) {
+        int w = lt.tree[0];
+        out[o] = (int)lt.key[w];
+        int p = ++pos[w];
+        lt.key[w] = (p < lens[w]) ? runs[w][p] : KMERGE_EXHAUSTED;
+        loser_tree_replay(&lt, w);
+    }
+    free(pos);
+    loser_tree_free(&lt);
+}
+
+// Сравнение голов серий a и b для обобщённого слияния: исчерпанная серия
+// (NULL) проигрывает любой, при равенстве выигрывает меньший номер
+static inline int generic_less(const void *pa, const void *pb, int a, int b, hmm_cmp_fn cmp) {
+    if (!pa)
+        return 0;
+    if (!pb)
+        return 1;
+    int c = cmp(pa, pb);
+    return c < 0 || (c == 0 && a < b);
+}
+
+// Слияние серий произвольных элементов размера size с компаратором cmp.
+// При равенстве побеждает серия с меньшим номером, так что слияние устойчиво
+void hmm_kmerge_generic(const void *runs[], const int lens[], int k, size_t size,
+                        hmm_cmp_fn cmp, void *out) {
+    if (k <= 0)
+        return;
+    int kp = 1;
+    while (kp < k)
+        kp <<= 1;
+    int *tree = malloc((size_t)kp * sizeof(int));
+    int *node_win = malloc(2 * (size_t)kp * sizeof(int));
+    int *pos = calloc((size_t)kp, sizeof(int));
+    if (!tree || !node_win || !pos) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_kmerge_generic.\n");
+        exit(EXIT_FAILURE);
+    }
+    // Голова серии r или NULL, если серия исчерпана (или r – фиктивный лист)
+#define GENERIC_HEAD(r) (((r) < k && pos[r] < lens[r]) \
+                         ? (const char *)runs[r] + (size_t)pos[r] * size : NULL)
+#define GENERIC_LESS(a, b) generic_less(GENERIC_HEAD(a), GENERIC_HEAD(b), (a), (b), cmp)
+    long long total = 0;
+    for (int r = 0; r < k; r++)
+        total += lens[r];
+    for (int r = 0; r < kp; r++)
+        node_win[kp + r] = r;
+    for (int node = kp - 1; node > 0; node--) {
+        int a = node_win[2 * node], b = node_win[2 * node + 1];
+        int b_wins = GENERIC_LESS(b, a);
+        node_win[node] = b_wins ? b : a;
+        tree[node] = b_wins ? a : b;
+    }
+    tree[0] = node_win[1];
+    char *dst = out;
+    for (long long o = 0; o < total; o++) {
+        int w = tree[0];
+        memcpy(dst, (const char *)runs[w] + (size_t)pos[w] * size, size);
+        dst += size;
+        pos[w]++;
+        for (int node = (w + kp) >> 1; node > 0; node >>= 1) {
+            int other = tree[node];
+            if (GENERIC_LESS(other, w)) {
+                tree[node] = w;
+                w = other;
+            }
+        }
+        tree[0] = w;
+    }
+#undef GENERIC_LESS
+#undef GENERIC_HEAD
+    free(pos);
+    free(node_win);
+    free(tree);
+}
+
+/* ==================== Параллельное слияние ==================== */
+
+// Первая позиция в отсортированном a[0..n-1] со значением > key (или >= key при strict == 0)
+static int kmerge_bound(const int a[], int n, long long key, int strict) {
+    int lo = 0, hi = n;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strict ? a[mid] <= key : a[mid] < key)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// Поиск разделителя: позиции split[r] такие, что сумма split[r] равна rank,
+// а все элементы до позиций не больше элементов после. Значение разделителя
+// ищется двоичным поиском по диапазону int, равные ему элементы раздаются
+// сериям по порядку
+static void kmerge_split(const int *runs[], const int lens[], int k, long long rank, int split[]) {
+    long long lo = INT_MIN, hi = INT_MAX;
+    while (lo < hi) {
+        long long v = lo + (hi - lo) / 2;
+        long long le = 0;
+        for (int r = 0; r < k; r++)
+            le += kmerge_bound(runs[r], lens[r], v, 1);
+        if (le >= rank)
+            hi = v;
+        else
+            lo = v + 1;
+    }
+    long long need = rank;
+    for (int r = 0; r < k; r++) {
+        split[r] = kmerge_bound(runs[r], lens[r], lo, 0);
+        need -= split[r];
+    }
+    for (int r = 0; r < k && need > 0; r++) {
+        int equal = kmerge_bound(runs[r], lens[r], lo, 1) - split[r];
+        int take = (equal < need) ? equal : (int)need;
+        split[r] += take;
+        need -= take;
+    }
+}
+
+typedef struct {
+    const int **runs;
+    int *lens;
+    int k;
+    int *out;
+} kmerge_job;
+
+static void *kmerge_worker_main(void *arg) {
+    kmerge_job *job = arg;
+    hmm_kmerge(job->runs, job->lens, job->k, job->out);
+    return NULL;
+}
+
+// Параллельное слияние: выход делится на threads равных частей, границы частей
+// в сериях находятся поиском разделителей, и каждый поток сливает свою часть
+// независимо, записывая её сразу на окончательное место в out
+void hmm_kmerge_parallel(const int *runs[], const int lens[], int k, int out[], int threads) {
+    long long total = 0;
+    for (int r = 0; r < k; r++)
+        total += lens[r];
+    if (threads > total / 4096)
+        threads = (int)(total / 4096);
+    if (threads <= 1 || k <= 1) {
+        hmm_kmerge(runs, lens, k, out);
+        return;
+    }
+    int *split = malloc((size_t)(threads + 1) * k * sizeof(int));
+    const int **sub_runs = malloc((size_t)threads * k * sizeof(int *));
+    int *sub_lens = malloc((size_t)threads * k * sizeof(int));
+    kmerge_job *jobs = malloc(threads * sizeof(kmerge_job));
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    if (!split || !sub_runs || !sub_lens || !jobs || !tids) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_kmerge_parallel.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int r = 0; r < k; r++) {
+        split[r] = 0;
+        split[(size_t)threads * k + r] = lens[r];
+    }
+    for (int t = 1; t < threads; t++)
+        kmerge_split(runs, lens, k, total * t / threads, split + (size_t)t * k);
+    for (int t = 0; t < threads; t++) {
+        const int *begin = split + (size_t)t * k, *end = begin + k;
+        jobs[t].runs = sub_runs + (size_t)t * k;
+        jobs[t].lens = sub_lens + (size_t)t * k;
+        jobs[t].k = k;
+        jobs[t].out = out + total * t / threads;
+        for (int r = 0; r < k; r++) {
+            jobs[t].runs[r] = runs[r] + begin[r];
+            jobs[t].lens[r] = end[r] - begin[r];
+        }
+        if (pthread_create(&tids[t], NULL, kmerge_worker_main, &jobs[t]) != 0) {
+            fprintf(stderr, "Ошибка создания потока в hmm_kmerge_parallel.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < threads; t++)
+        pthread_join(tids[t], NULL);
+    free(tids);
+    free(jobs);
+    free(sub_lens);
+    free(sub_runs);
+    free(split);
+}
+
+/* ==================== Потоковые серии ==================== */
+
+// Слияние серий, читаемых блоками через readers[r].read, с выдачей результата
+// блоками через write. Каждой серии и выходу нужен лишь буфер KMERGE_STREAM_BUF
+// элементов, так что слияние годится для внешней сортировки и приёма данных
+// по сети. Возвращает число записанных элементов или -1 при ошибке чтения/записи
+long long hmm_kmerge_stream(hmm_run_reader readers[], int k, hmm_run_writer write, void *write_ctx) {
+    if (k <= 0)
+        return 0;
+    loser_tree lt;
+    loser_tree_init(&lt, k);
+    int *buf = malloc((size_t)(k + 1) * KMERGE_STREAM_BUF * sizeof(int));
+    int *pos = calloc((size_t)k, sizeof(int));
+    int *len = calloc((size_t)k, sizeof(int));
+    if (!buf || !pos || !len) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_kmerge_stream.\n");
+        exit(EXIT_FAILURE);
+    }
+    int *out = buf + (size_t)k * KMERGE_STREAM_BUF;
+    long long written = 0;
+    int n_out = 0, failed = 0;
+    for (int r = 0; r < k && !failed; r++) {
+        len[r] = readers[r].read(readers[r].ctx, buf + (size_t)r * KMERGE_STREAM_BUF, KMERGE_STREAM_BUF);
+        if (len[r] < 0)
+            failed = 1;
+        else if (len[r] > 0)
+            lt.key[r] = buf[(size_t)r * KMERGE_STREAM_BUF];
+    }
+    if (!failed)
+        loser_tree_build(&lt);
+    while (!failed && lt.key[lt.tree[0]] != KMERGE_EXHAUSTED) {
+        int w = lt.tree[0];
+        out[n_out++] = (int)lt.key[w];
+        if (n_out == KMERGE_STREAM_BUF) {
+            if (write(write_ctx, out, n_out) != 0)
+                failed = 1;
+            written += n_out;
+            n_out = 0;
+        }
+        int *run_buf = buf + (size_t)w * KMERGE_STREAM_BUF;
+        if (++pos[w] == len[w]) {
+            // Буфер серии исчерпан – подкачка следующего блока
+            len[w] = readers[w].read(readers[w].ctx, run_buf, KMERGE_STREAM_BUF);
+            pos[w] = 0;
+            if (len[w] < 0)
+                failed = 1;
+        }
+        lt.key[w] = (len[w] > 0) ? run_buf[pos[w]] : KMERGE_EXHAUSTED;
+        loser_tree_replay(&lt, w);
+    }
+    if (!failed && n_out > 0) {
+        if (write(write_ctx, out, n_out) != 0)
+            failed = 1;
+        written += n_out;
+    }
+    free(len);
+    free(pos);
+    free(buf);
+    loser_tree_free(&lt);
+    return failed ? -1 : written;
+}
@@ -0,0 +1,260 @@
+/*
+ * min_max_sort_large.c
+ *
+ * Режим пропускной способности для очень больших массивов int: буферы на
+ * страницах 2 МБ (hugetlbfs или прозрачные большие страницы), программная
+ * предвыборка в проходе разбиения и в потоках слияния, потоковые
+ * (non-temporal) записи при слиянии длинных серий.
+ */
+
+#define _GNU_SOURCE
+#include "min_max_sort.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define HUGE_PAGE_SIZE (2u * 1024 * 1024)
+#define LARGE_HANDOFF (1 << 16)        // сегменты меньше – обычному драйверу
+#define LARGE_STACK_SIZE 64
+#define PREFETCH_DISTANCE 64           // элементов вперёд (4 строки кэша)
+#define STREAM_MIN_RUN (1 << 18)       // слияния с выходом длиннее – потоковыми записями
+
+/* ==================== Буферы на больших страницах ==================== */
+
+// Выделение памяти на страницах 2 МБ: сначала из пула hugetlbfs, затем
+// обычное отображение, выровненное по 2 МБ, с madvise(MADV_HUGEPAGE)
+void *hmm_huge_alloc(size_t bytes, size_t *mapped) {
+    size_t size = (bytes + HUGE_PAGE_SIZE - 1) & ~(size_t)(HUGE_PAGE_SIZE - 1);
+    if (size == 0)
+        size = HUGE_PAGE_SIZE;
+#ifdef MAP_HUGETLB
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (p != MAP_FAILED) {
+        *mapped = size;
+        return p;
+    }
+#endif
+    // Запас в одну большую страницу на выравнивание, лишнее возвращается системе
+    size_t total = size + HUGE_PAGE_SIZE;
+    char *raw = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return NULL;
+    char *aligned = (char *)(((uintptr_t)raw + HUGE_PAGE_SIZE - 1) & ~(uintptr_t)(HUGE_PAGE_SIZE - 1));
+    if (aligned > raw)
+        munmap(raw, aligned - raw);
+    if (raw + total > aligned + size)
+        munmap(aligned + size, raw + total - (aligned + size));
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+    *mapped = size;
+    return aligned;
+}
+
+void hmm_huge_free(void *p, size_t mapped) {
+    if (p)
+        munmap(p, mapped);
+}
+
+/* ==================== Ядра с предвыборкой и потоковыми записями ==================== */
+
+static inline void store_int(int *dst, int value, int streaming) {
+#ifdef __SSE2__
+    if (streaming) {
+        _mm_stream_si32(dst, value);
+        return;
+    }
+#else
+    (void)streaming;
+#endif
+    *dst = value;
+}
+
+// Слияние src[lo..mid-1] и src[mid..hi-1] в dst[lo..hi-1] с предвыборкой обоих потоков.
+// Адрес предвыборки берётся только внутри своей серии: указатель за концом
+// массива формировать нельзя
+static void merge_streams(const int *src, int *dst, int lo, int mid, int hi) {
+    int streaming = hi - lo >= STREAM_MIN_RUN;
+    int i = lo, j = mid, k = lo;
+    while (i < mid && j < hi) {
+        if (i + PREFETCH_DISTANCE < mid)
+            __builtin_prefetch(&src[i + PREFETCH_DISTANCE], 0);
+        if (j + PREFETCH_DISTANCE < hi)
+            __builtin_prefetch(&src[j + PREFETCH_DISTANCE], 0);
+        int a = src[i], b = src[j];
+        int take_left = a <= b;
+        store_int(&dst[k++], take_left ? a : b, streaming);
+        i += take_left;
+        j += !take_left;
+    }
+    while (i < mid)
+        store_int(&dst[k++], src[i++], streaming);
+    while (j < hi)
+        store_int(&dst[k++], src[j++], streaming);
+}
+
+// Восходящая сортировка слиянием arr[0..n-1] с перекладыванием между массивом
+// и scratch (не меньше n элементов); короткие блоки сортируются вставками
+static void merge_sort_scratch(int arr[], int n, int *scratch) {
+    int block = hmm_tuning_profile.int_params.insertion_threshold;
+    if (block < 2)
+        block = 2;
+    for (int lo = 0; lo < n; lo += block)
+        hmm_insertion_sort(arr, lo, (lo + block < n ? lo + block : n) - 1);
+
+    int *src = arr, *dst = scratch;
+    for (long long width = block; width < n; width *= 2) {
+        for (long long lo = 0; lo < n; lo += 2 * width) {
+            int mid = (int)(lo + width < n ? lo + width : n);
+            int hi = (int)(lo + 2 * width < n ? lo + 2 * width : n);
+            merge_streams(src, dst, (int)lo, mid, hi);
+        }
+        int *t = src;
+        src = dst;
+        dst = t;
+    }
+#ifdef __SSE2__
+    _mm_sfence();
+#endif
+    if (src != arr)
+        memcpy(arr, src, (size_t)n * sizeof(int));
+}
+
+// Буфер на больших страницах под n элементов
+static int *large_scratch(int n, size_t *mapped) {
+    int *scratch = hmm_huge_alloc((size_t)n * sizeof(int), mapped);
+    if (!scratch) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_merge_sort_large.\n");
+        exit(EXIT_FAILURE);
+    }
+    return scratch;
+}
+
+// Сортировка слиянием с буфером на больших страницах
+void hmm_merge_sort_large(int arr[], int n) {
+    hmm_tuning_init();
+    if (n < 2)
+        return;
+    size_t mapped;
+    int *scratch = large_scratch(n, &mapped);
+    merge_sort_scratch(arr, n, scratch);
+    hmm_huge_free(scratch, mapped);
+}
+
+// Разбиение по опорным значениям с предвыборкой на запись с обоих концов
+static void partition_prefetch(int arr[], int left, int right, int lowerPivot, int upperPivot,
+                               int *out_l, int *out_r) {
+    int l = left, r = right;
+    for (int i = left; i <= r;) {
+        if (i + PREFETCH_DISTANCE <= right)
+            __builtin_prefetch(&arr[i + PREFETCH_DISTANCE], 1);
+        if (r - PREFETCH_DISTANCE >= left)
+            __builtin_prefetch(&arr[r - PREFETCH_DISTANCE], 1);
+        int x = arr[i];
+        if (x < lowerPivot) {
+            arr[i] = arr[l];
+            arr[l] = x;
+            l++;
+            i++;
+        } else if (x > upperPivot) {
+            arr[i] = arr[r];
+            arr[r] = x;
+            r--;
+        } else {
+            i++;
+        }
+    }
+    *out_l = l;
+    *out_r = r;
+}
+
+/* ==================== Драйвер ==================== */
+
+// Сортировка очень больших массивов: верхние, упирающиеся в память уровни
+// разбиваются с предвыборкой, запасной путь – слияние на больших страницах,
+// сегменты меньше LARGE_HANDOFF досортировываются hybrid_min_max_sort_serial.
+// Границы значений и предел глубины сегментов ведутся так же, как в
+// hybrid_min_max_sort_serial. Буфер слияния выделяется при первом запасном
+// слиянии – сразу на весь массив – и служит до конца сортировки
+void hybrid_min_max_sort_large(int arr[], int n) {
+    int stack_left[LARGE_STACK_SIZE], stack_right[LARGE_STACK_SIZE];
+    int stack_min[LARGE_STACK_SIZE], stack_max[LARGE_STACK_SIZE];
+    int stack_depth[LARGE_STACK_SIZE];
+    int top = 0, depth = 0, max_depth = 0;
+    int left = 0, right = n - 1, min_value, max_value;
+    int *scratch = NULL;
+    size_t mapped = 0;
+
+    hmm_tuning_init();
+    if (n < 2 || hmm_prescan_min_max(arr, 0, n - 1, &min_value, &max_value))
+        return;
+    max_depth = hmm_depth_limit(n);
+
+    for (;;) {
+        int segment_size = right - left + 1;
+        long long range = (long long)max_value - min_value;
+        if (range == 0 || segment_size <= 1) {
+            // Все значения равны
+        } else if (segment_size < LARGE_HANDOFF) {
+            hybrid_min_max_sort_serial(arr, left, right, 2);
+        } else if (range < segment_size) {
+            hmm_counting_sort_range(arr, left, right, min_value, max_value);
+        } else if (depth >= max_depth) {
+            if (!scratch)
+                scratch = large_scratch(n, &mapped);
+            merge_sort_scratch(arr + left, segment_size, scratch);
+        } else {
+            int i_low = hmm_select_lower_pivot(arr, left, right, segment_size);
+            int i_high = hmm_select_upper_pivot(arr, left, right, segment_size);
+            int lowerPivot = arr[i_low], upperPivot = arr[i_high];
+            if (lowerPivot > upperPivot) {
+                int t = lowerPivot;
+                lowerPivot = upperPivot;
+                upperPivot = t;
+            }
+            hmm_nudge_pivots(&lowerPivot, &upperPivot, min_value, max_value);
+            int l, r;
+            partition_prefetch(arr, left, right, lowerPivot, upperPivot, &l, &r);
+            if (l == left || r == right) {
+                if (!scratch)
+                    scratch = large_scratch(n, &mapped);
+                merge_sort_scratch(arr + left, segment_size, scratch);
+            } else {
+                int lo[3] = { left, l, r + 1 }, hi[3] = { l - 1, r, right };
+                int vmin[3] = { min_value, lowerPivot, upperPivot + 1 };
+                int vmax[3] = { lowerPivot - 1, upperPivot, max_value };
+                int order[3];
+                hmm_part_order(lo, hi, order);
+                for (int q = 0; q < 2; q++) {
+                    int p = order[q];
+                    stack_left[top] = lo[p];
+                    stack_right[top] = hi[p];
+                    stack_min[top] = vmin[p];
+                    stack_depth[top] = depth + 1;
+                    stack_max[top++] = vmax[p];
+                }
+                int small = order[2];
+                left = lo[small];
+                right = hi[small];
+                min_value = vmin[small];
+                max_value = vmax[small];
+                depth++;
+                continue;
+            }
+        }
+        if (top == 0)
+            break;
+        top--;
+        left = stack_left[top];
+        right = stack_right[top];
+        min_value = stack_min[top];
+        max_value = stack_max[top];
+        depth = stack_depth[top];
+    }
+    hmm_huge_free(scratch, mapped);
+}
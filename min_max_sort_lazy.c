@@ -0,0 +1,108 @@
+/*
+ * min_max_sort_lazy.c
+ *
+ * Ленивый отсортированный итератор (инкрементальная быстрая сортировка):
+ * массив разбивается тем же трёхчастным разбиением, но только настолько,
+ * насколько нужно для выдачи следующего элемента или страницы. Отложенные
+ * правые части лежат в стеке итератора и обрабатываются, только если
+ * потребитель продолжает чтение. Первые m элементов стоят O(n + m log m).
+ */
+
+#include "min_max_sort.h"
+#include <string.h>
+
+void hmm_lazy_iter_init(hmm_lazy_iter *it, int arr[], int n) {
+    hmm_tuning_init();
+    memset(it, 0, sizeof(*it));
+    it->arr = arr;
+    it->n = n;
+    if (n <= 1 || hmm_prescan_min_max(arr, 0, n - 1, &it->stack_min[0], &it->stack_max[0])) {
+        // Уже отсортирован – все элементы на своих местах
+        it->ready = n;
+        return;
+    }
+    it->stack_left[0] = 0;
+    it->stack_right[0] = n - 1;
+    it->stack_depth[0] = 0;
+    it->top = 1;
+    it->max_depth = hmm_depth_limit(n);
+}
+
+// Продвижение границы ready до target: берётся самый левый отложенный сегмент;
+// мелкий, узкий по значениям или слишком глубокий досортировывается целиком,
+// остальные разбиваются, и части кладутся в стек так, что левая – сверху
+static void lazy_advance(hmm_lazy_iter *it, int target) {
+    int *arr = it->arr;
+    while (it->ready < target && it->top > 0) {
+        it->top--;
+        int left = it->stack_left[it->top], right = it->stack_right[it->top];
+        int min_value = it->stack_min[it->top], max_value = it->stack_max[it->top];
+        int depth = it->stack_depth[it->top];
+        int segment_size = right - left + 1;
+        long long range = (long long)max_value - min_value;
+        if (segment_size <= 0)
+            continue;
+        if (range == 0) {
+            // Все значения равны
+        } else if (segment_size <= hmm_get_adaptive_threshold(segment_size)) {
+            hmm_insertion_sort(arr, left, right);
+        } else if (range < segment_size) {
+            hmm_counting_sort_range(arr, left, right, min_value, max_value);
+        } else if (depth >= it->max_depth) {
+            hmm_merge_sort(arr, left, right);
+        } else {
+            int i_low = hmm_select_lower_pivot(arr, left, right, segment_size);
+            int i_high = hmm_select_upper_pivot(arr, left, right, segment_size);
+            int lowerPivot = arr[i_low], upperPivot = arr[i_high];
+            if (lowerPivot > upperPivot) {
+                int t = lowerPivot;
+                lowerPivot = upperPivot;
+                upperPivot = t;
+            }
+            hmm_nudge_pivots(&lowerPivot, &upperPivot, min_value, max_value);
+            int l, r;
+            hmm_partition_by_pivots(arr, left, right, lowerPivot, upperPivot, &l, &r);
+            if (l == left || r == right) {
+                hmm_merge_sort(arr, left, right);
+            } else {
+                int lo[3] = { left, l, r + 1 }, hi[3] = { l - 1, r, right };
+                int vmin[3] = { min_value, lowerPivot, upperPivot + 1 };
+                int vmax[3] = { lowerPivot - 1, upperPivot, max_value };
+                for (int p = 2; p >= 0; p--) {
+                    it->stack_left[it->top] = lo[p];
+                    it->stack_right[it->top] = hi[p];
+                    it->stack_min[it->top] = vmin[p];
+                    it->stack_max[it->top] = vmax[p];
+                    it->stack_depth[it->top++] = depth + 1;
+                }
+                continue;
+            }
+        }
+        it->ready = right + 1;
+    }
+}
+
+// Следующий по порядку элемент в *out; 0 – элементы закончились
+int hmm_lazy_iter_next(hmm_lazy_iter *it, int *out) {
+    if (it->next >= it->n)
+        return 0;
+    if (it->next >= it->ready)
+        lazy_advance(it, it->next + 1);
+    *out = it->arr[it->next++];
+    return 1;
+}
+
+// Следующая страница из не более чем max элементов: *page указывает на неё
+// внутри массива (элементы уже на окончательных местах). Возвращает её длину
+int hmm_lazy_iter_page(hmm_lazy_iter *it, int max, const int **page) {
+    int count = it->n - it->next;
+    if (count > max)
+        count = max;
+    if (count <= 0)
+        return 0;
+    if (it->next + count > it->ready)
+        lazy_advance(it, it->next + count);
+    *page = it->arr + it->next;
+    it->next += count;
+    return count;
+}
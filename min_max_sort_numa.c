@@ -0,0 +1,313 @@
+/*
+ * min_max_sort_numa.c
+ *
+ * Параллельная гибридная сортировка Min-Max с учётом топологии NUMA (Linux).
+ *
+ * Первый уровень разбиения – сэмплированные разделители: каждый поток
+ * получает свой диапазон значений (корзину), так что корзины одного узла
+ * лежат в массиве подряд. Буфер корзины выделяет и первым касается поток,
+ * который её сортирует, поэтому страницы оказываются на его узле, а сама
+ * сортировка идёт в локальной памяти. Итоговое слияние сводится к
+ * копированию корзины узла на её окончательное место в массиве.
+ */
+
+#define _GNU_SOURCE
+#include "min_max_sort.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define NUMA_SAMPLES_PER_THREAD 32
+#define NUMA_MIN_PER_THREAD 4096
+
+/* ==================== Топология ==================== */
+
+// Разбор списка CPU в формате /sys ("0-3,8,10-11")
+int hmm_numa_parse_cpulist(const char *s, int out[], int max) {
+    int count = 0;
+    while (*s && *s != '\n') {
+        char *end;
+        long a = strtol(s, &end, 10);
+        if (end == s)
+            return -1;
+        long b = a;
+        s = end;
+        if (*s == '-') {
+            b = strtol(s + 1, &end, 10);
+            if (end == s + 1 || b < a)
+                return -1;
+            s = end;
+        }
+        for (long c = a; c <= b && count < max; c++)
+            out[count++] = (int)c;
+        if (*s == ',')
+            s++;
+        else if (*s && *s != '\n')
+            return -1;
+    }
+    return count;
+}
+
+// Чтение одной строки файла /sys
+static int read_sys_line(const char *path, char *buf, int size) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return 0;
+    int ok = fgets(buf, size, f) != NULL;
+    fclose(f);
+    return ok;
+}
+
+// Определение топологии: переменная HMM_NUMA_TOPOLOGY ("0-3;4-7" – списки CPU
+// узлов через ';') позволяет эмулировать несколько узлов на однопроцессорной машине,
+// иначе топология читается из /sys/devices/system/node
+int hmm_numa_detect(hmm_numa_topology *topo) {
+    char line[4096];
+    memset(topo, 0, sizeof(*topo));
+
+    const char *env = getenv("HMM_NUMA_TOPOLOGY");
+    if (env && *env) {
+        const char *p = env;
+        while (*p && topo->node_count < HMM_MAX_NUMA_NODES) {
+            const char *sep = strchr(p, ';');
+            size_t len = sep ? (size_t)(sep - p) : strlen(p);
+            if (len >= sizeof(line))
+                break;
+            memcpy(line, p, len);
+            line[len] = '\0';
+            int c = hmm_numa_parse_cpulist(line, topo->cpus[topo->node_count], HMM_MAX_NODE_CPUS);
+            if (c > 0)
+                topo->cpu_count[topo->node_count++] = c;
+            if (!sep)
+                break;
+            p = sep + 1;
+        }
+        if (topo->node_count > 0)
+            return topo->node_count;
+    }
+
+    int nodes[HMM_MAX_NUMA_NODES];
+    int node_count = 0;
+    if (read_sys_line("/sys/devices/system/node/online", line, sizeof(line)))
+        node_count = hmm_numa_parse_cpulist(line, nodes, HMM_MAX_NUMA_NODES);
+    for (int i = 0; i < node_count; i++) {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[i]);
+        if (!read_sys_line(path, line, sizeof(line)))
+            continue;
+        int c = hmm_numa_parse_cpulist(line, topo->cpus[topo->node_count], HMM_MAX_NODE_CPUS);
+        if (c > 0)
+            topo->cpu_count[topo->node_count++] = c;
+    }
+
+    // Без /sys считаем машину одним узлом со всеми онлайн-процессорами
+    if (topo->node_count == 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+        if (ncpu < 1)
+            ncpu = 1;
+        if (ncpu > HMM_MAX_NODE_CPUS)
+            ncpu = HMM_MAX_NODE_CPUS;
+        for (int c = 0; c < ncpu; c++)
+            topo->cpus[0][c] = c;
+        topo->cpu_count[0] = (int)ncpu;
+        topo->node_count = 1;
+    }
+    return topo->node_count;
+}
+
+/* ==================== Параллельная сортировка ==================== */
+
+typedef struct {
+    int *arr;
+    int n;
+    int threads;
+    const int *splitters;       // threads - 1 разделителей
+    int *hist;                  // hist[w * threads + b] – число элементов полосы w в корзине b
+    int **bucket_buf;           // буферы корзин, выделяются потоками-владельцами
+    pthread_barrier_t barrier;
+} numa_shared;
+
+typedef struct {
+    numa_shared *sh;
+    int id;
+    int cpu;
+} numa_worker;
+
+// Номер корзины: число разделителей, не превосходящих x
+static inline int bucket_of(const int splitters[], int count, int x) {
+    int lo = 0, len = count;
+    while (len > 0) {
+        int half = len / 2;
+        int take = splitters[lo + half] <= x;
+        lo += take ? half + 1 : 0;
+        len = take ? len - half - 1 : half;
+    }
+    return lo;
+}
+
+static void *numa_worker_main(void *p) {
+    numa_worker *wk = p;
+    numa_shared *sh = wk->sh;
+    int T = sh->threads, w = wk->id;
+
+    // Закрепление за процессором своего узла; ошибка (например, эмулированный
+    // CPU, которого нет) не мешает сортировке
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(wk->cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+
+    int from = (int)((long long)sh->n * w / T);
+    int to = (int)((long long)sh->n * (w + 1) / T);
+    int *hist = &sh->hist[w * T];
+
+    // 1. Гистограмма своей полосы входа
+    {
+        HMM_TRACE_BEGIN(to - from);
+        for (int i = from; i < to; i++)
+            hist[bucket_of(sh->splitters, T - 1, sh->arr[i])]++;
+        HMM_TRACE_END(to - from, 0, 0, HMM_TRACE_PART_ROOT, HMM_TRACE_HISTOGRAM);
+    }
+    pthread_barrier_wait(&sh->barrier);
+
+    // 2. Буфер своей корзины: первое касание с потока-владельца
+    int size = 0;
+    for (int i = 0; i < T; i++)
+        size += sh->hist[i * T + w];
+    int *buf = malloc((size > 0 ? size : 1) * sizeof(int));
+    if (!buf) {
+        fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_sort_numa.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(buf, 0, size * sizeof(int));
+    sh->bucket_buf[w] = buf;
+    pthread_barrier_wait(&sh->barrier);
+
+    // 3. Раскладка своей полосы по корзинам
+    int *cursor = malloc(T * sizeof(int));
+    if (!cursor) {
+        fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_sort_numa.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int b = 0; b < T; b++) {
+        cursor[b] = 0;
+        for (int i = 0; i < w; i++)
+            cursor[b] += sh->hist[i * T + b];
+    }
+    {
+        HMM_TRACE_BEGIN(to - from);
+        for (int i = from; i < to; i++) {
+            int x = sh->arr[i];
+            int b = bucket_of(sh->splitters, T - 1, x);
+            sh->bucket_buf[b][cursor[b]++] = x;
+        }
+        HMM_TRACE_END(to - from, 0, 0, HMM_TRACE_PART_ROOT, HMM_TRACE_SCATTER);
+    }
+    free(cursor);
+    pthread_barrier_wait(&sh->barrier);
+
+    // 4. Локальная сортировка корзины и перенос на её место в массиве
+    if (size > 0) {
+        // Границы корзины – соседние разделители
+        HMM_TRACE_BEGIN(size);
+        hybrid_min_max_sort_serial(buf, 0, size - 1, 2);
+        HMM_TRACE_END(size, w > 0 ? sh->splitters[w - 1] : 0, w < T - 1 ? sh->splitters[w] : 0,
+                      HMM_TRACE_PART_ROOT, HMM_TRACE_BUCKET);
+    }
+    int start = 0;
+    for (int b = 0; b < w; b++)
+        for (int i = 0; i < T; i++)
+            start += sh->hist[i * T + b];
+    memcpy(&sh->arr[start], buf, size * sizeof(int));
+    free(buf);
+    return NULL;
+}
+
+// Топология пригодна, если у неё есть узлы и у каждого узла есть процессоры
+static int numa_topology_valid(const hmm_numa_topology *topo) {
+    if (topo->node_count <= 0 || topo->node_count > HMM_MAX_NUMA_NODES)
+        return 0;
+    for (int i = 0; i < topo->node_count; i++)
+        if (topo->cpu_count[i] <= 0 || topo->cpu_count[i] > HMM_MAX_NODE_CPUS)
+            return 0;
+    return 1;
+}
+
+// Параллельная сортировка с учётом NUMA. threads <= 0 – по числу процессоров,
+// topo == NULL или непригодная топология (нет узлов, узел без процессоров) –
+// топология определяется автоматически
+void hybrid_min_max_sort_numa(int arr[], int n, int threads, const hmm_numa_topology *topo) {
+    hmm_numa_topology detected;
+    if (!topo || !numa_topology_valid(topo)) {
+        hmm_numa_detect(&detected);
+        topo = &detected;
+    }
+    if (threads <= 0) {
+        threads = 0;
+        for (int i = 0; i < topo->node_count; i++)
+            threads += topo->cpu_count[i];
+    }
+    if (threads > n / NUMA_MIN_PER_THREAD)
+        threads = n / NUMA_MIN_PER_THREAD;
+    if (threads <= 1) {
+        if (n > 1)
+            hybrid_min_max_sort_serial(arr, 0, n - 1, 2);
+        return;
+    }
+
+    // Разделители из равномерной выборки
+    int samples = threads * NUMA_SAMPLES_PER_THREAD;
+    int *sample = malloc(samples * sizeof(int));
+    int *splitters = malloc((threads - 1) * sizeof(int));
+    int *hist = calloc((size_t)threads * threads, sizeof(int));
+    int **bucket_buf = malloc(threads * sizeof(int *));
+    numa_worker *workers = malloc(threads * sizeof(numa_worker));
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    if (!sample || !splitters || !hist || !bucket_buf || !workers || !tids) {
+        fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_sort_numa.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < samples; i++)
+        sample[i] = arr[(int)((long long)n * i / samples)];
+    hybrid_min_max_sort_serial(sample, 0, samples - 1, 2);
+    for (int b = 0; b < threads - 1; b++)
+        splitters[b] = sample[(b + 1) * NUMA_SAMPLES_PER_THREAD];
+
+    numa_shared sh = {
+        .arr = arr,
+        .n = n,
+        .threads = threads,
+        .splitters = splitters,
+        .hist = hist,
+        .bucket_buf = bucket_buf,
+    };
+    pthread_barrier_init(&sh.barrier, NULL, threads);
+
+    // Потоки идут блоками по узлам, чтобы корзины узла лежали подряд
+    for (int w = 0; w < threads; w++) {
+        int node = (int)((long long)w * topo->node_count / threads);
+        int first = (int)(((long long)node * threads + topo->node_count - 1) / topo->node_count);
+        workers[w].sh = &sh;
+        workers[w].id = w;
+        workers[w].cpu = topo->cpus[node][(w - first) % topo->cpu_count[node]];
+    }
+    for (int w = 0; w < threads; w++) {
+        if (pthread_create(&tids[w], NULL, numa_worker_main, &workers[w]) != 0) {
+            fprintf(stderr, "Ошибка создания потока в hybrid_min_max_sort_numa.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int w = 0; w < threads; w++)
+        pthread_join(tids[w], NULL);
+
+    pthread_barrier_destroy(&sh.barrier);
+    free(tids);
+    free(workers);
+    free(bucket_buf);
+    free(hist);
+    free(splitters);
+    free(sample);
+}
@@ -0,0 +1,232 @@
+/*
+ * min_max_sort_partition.c
+ *
+ * Разбиение массива int на корзины по диапазонам значений без сортировки
+ * внутри корзин (для шардирования и гистограмм). Разделители задаются или
+ * выбираются по выборке. Последовательный путь работает на месте: при трёх
+ * корзинах – одним трёхчастным разбиением hmm_partition_by_pivots, иначе –
+ * подсчётом и перестановкой циклами ("американский флаг"), два прохода.
+ * Параллельный путь – гистограммы по потокам, раскладка в буфер и возврат.
+ */
+
+#include "min_max_sort.h"
+#include <limits.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PARTITION_SAMPLES_PER_BUCKET 32
+#define PARTITION_MIN_PER_THREAD 65536
+
+// Номер корзины значения: число разделителей, не превосходящих v.
+// Двоичный поиск без ветвлений по отсортированным splitters[0..m-1]
+static inline int bucket_of(const int splitters[], int m, int v) {
+    int base = 0, len = m;
+    while (len > 0) {
+        int half = len / 2;
+        int go = splitters[base + half] <= v;
+        base = go ? base + half + 1 : base;
+        len = go ? len - half - 1 : half;
+    }
+    return base;
+}
+
+// Разделители по равномерной выборке: bucket_count * PARTITION_SAMPLES_PER_BUCKET
+// элементов с шагом, отсортированных, и каждый PARTITION_SAMPLES_PER_BUCKET-й из них
+static void sample_splitters(const int arr[], int n, int bucket_count, int splitters[]) {
+    int samples = bucket_count * PARTITION_SAMPLES_PER_BUCKET;
+    if (samples > n)
+        samples = n;
+    int *sample = malloc((size_t)samples * sizeof(int));
+    if (!sample) {
+        fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_partition.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < samples; i++)
+        sample[i] = arr[(long long)i * n / samples];
+    hybrid_min_max_sort_serial(sample, 0, samples - 1, 2);
+    for (int b = 1; b < bucket_count; b++)
+        splitters[b - 1] = sample[(long long)b * samples / bucket_count];
+    free(sample);
+}
+
+/* ==================== Последовательный путь ==================== */
+
+// Подсчёт и перестановка циклами: каждый элемент переносится сразу в свою корзину.
+// Номера корзин первого прохода запоминаются по исходным позициям (uint16_t на
+// элемент). Сам массив номеров не переставляется: он читается только на ещё не
+// размещённых позициях, где лежит исходный элемент, а номер переносимого
+// элемента хранится в переменной рядом с ним. Так каждое значение
+// классифицируется один раз; если памяти под номера нет или корзин больше
+// 65536 – классификация повторяется
+static void partition_serial(int arr[], int n, const int splitters[], int bucket_count, int offsets[]) {
+    int m = bucket_count - 1;
+    int *next = malloc((size_t)bucket_count * sizeof(int));
+    uint16_t *oracle = (bucket_count <= 65536) ? malloc((size_t)n * sizeof(uint16_t)) : NULL;
+    if (!next) {
+        fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_partition.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(offsets, 0, (size_t)(bucket_count + 1) * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        int d = bucket_of(splitters, m, arr[i]);
+        if (oracle)
+            oracle[i] = (uint16_t)d;
+        offsets[d + 1]++;
+    }
+    for (int b = 0; b < bucket_count; b++) {
+        offsets[b + 1] += offsets[b];
+        next[b] = offsets[b];
+    }
+    for (int b = 0; b < bucket_count; b++) {
+        while (next[b] < offsets[b + 1]) {
+            int i = next[b];
+            int v = arr[i];
+            int d = oracle ? oracle[i] : bucket_of(splitters, m, v);
+            while (d != b) {
+                int j = next[d]++;
+                int t = arr[j];
+                int td = oracle ? oracle[j] : bucket_of(splitters, m, t);
+                arr[j] = v;
+                v = t;
+                d = td;
+            }
+            arr[next[b]++] = v;
+        }
+    }
+    free(oracle);
+    free(next);
+}
+
+/* ==================== Параллельный путь ==================== */
+
+typedef struct {
+    int *arr, *buf;
+    uint16_t *oracle;        // номера корзин первого прохода (или NULL)
+    const int *splitters;
+    int bucket_count;
+    int begin, end;          // свой участок массива
+    int *count;              // гистограмма участка, затем позиции записи
+    int copy_begin, copy_end;
+    pthread_barrier_t *barrier;
+} partition_worker;
+
+static void *partition_worker_main(void *arg) {
+    partition_worker *w = arg;
+    int m = w->bucket_count - 1;
+    for (int i = w->begin; i < w->end; i++) {
+        int d = bucket_of(w->splitters, m, w->arr[i]);
+        if (w->oracle)
+            w->oracle[i] = (uint16_t)d;
+        w->count[d]++;
+    }
+    // Главный поток переводит гистограммы в позиции записи
+    pthread_barrier_wait(w->barrier);
+    pthread_barrier_wait(w->barrier);
+    for (int i = w->begin; i < w->end; i++) {
+        int v = w->arr[i];
+        int d = w->oracle ? w->oracle[i] : bucket_of(w->splitters, m, v);
+        w->buf[w->count[d]++] = v;
+    }
+    pthread_barrier_wait(w->barrier);
+    memcpy(w->arr + w->copy_begin, w->buf + w->copy_begin,
+           (size_t)(w->copy_end - w->copy_begin) * sizeof(int));
+    return NULL;
+}
+
+static void partition_parallel(int arr[], int n, const int splitters[], int bucket_count,
+                               int offsets[], int threads) {
+    int *buf = malloc((size_t)n * sizeof(int));
+    uint16_t *oracle = (bucket_count <= 65536) ? malloc((size_t)n * sizeof(uint16_t)) : NULL;
+    int *counts = calloc((size_t)threads * bucket_count, sizeof(int));
+    partition_worker *workers = malloc(threads * sizeof(partition_worker));
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    if (!buf || !counts || !workers || !tids) {
+        fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_partition.\n");
+        exit(EXIT_FAILURE);
+    }
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, threads + 1);
+    for (int w = 0; w < threads; w++) {
+        workers[w].arr = arr;
+        workers[w].buf = buf;
+        workers[w].oracle = oracle;
+        workers[w].splitters = splitters;
+        workers[w].bucket_count = bucket_count;
+        workers[w].begin = (int)((long long)n * w / threads);
+        workers[w].end = (int)((long long)n * (w + 1) / threads);
+        workers[w].count = counts + (size_t)w * bucket_count;
+        workers[w].copy_begin = workers[w].begin;
+        workers[w].copy_end = workers[w].end;
+        workers[w].barrier = &barrier;
+        if (pthread_create(&tids[w], NULL, partition_worker_main, &workers[w]) != 0) {
+            fprintf(stderr, "Ошибка создания потока в hybrid_min_max_partition.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_barrier_wait(&barrier);
+    // Корзина b начинается после всех меньших корзин; внутри неё участки
+    // потоков идут по порядку номеров
+    int pos = 0;
+    for (int b = 0; b < bucket_count; b++) {
+        offsets[b] = pos;
+        for (int w = 0; w < threads; w++) {
+            int c = workers[w].count[b];
+            workers[w].count[b] = pos;
+            pos += c;
+        }
+    }
+    offsets[bucket_count] = pos;
+    pthread_barrier_wait(&barrier);
+    pthread_barrier_wait(&barrier);
+    for (int w = 0; w < threads; w++)
+        pthread_join(tids[w], NULL);
+    pthread_barrier_destroy(&barrier);
+    free(tids);
+    free(workers);
+    free(counts);
+    free(oracle);
+    free(buf);
+}
+
+// Разбиение arr[0..n-1] на bucket_count корзин: корзина b – значения из
+// [splitters[b-1], splitters[b]) (крайние корзины не ограничены снизу/сверху)
+// занимает arr[offsets[b]..offsets[b+1]-1]; offsets – bucket_count + 1 чисел.
+// splitters – bucket_count - 1 неубывающих значений или NULL (выбор по выборке).
+// threads > 1 включает параллельный путь для больших массивов
+void hybrid_min_max_partition(int arr[], int n, const int splitters[], int bucket_count,
+                              int offsets[], int threads) {
+    if (bucket_count <= 1 || n <= 0) {
+        for (int b = 0; b <= bucket_count; b++)
+            offsets[b] = (b == bucket_count) ? n : 0;
+        return;
+    }
+    int *own = NULL;
+    if (!splitters) {
+        own = malloc((size_t)(bucket_count - 1) * sizeof(int));
+        if (!own) {
+            fprintf(stderr, "Ошибка выделения памяти в hybrid_min_max_partition.\n");
+            exit(EXIT_FAILURE);
+        }
+        sample_splitters(arr, n, bucket_count, own);
+        splitters = own;
+    }
+    if (threads > n / PARTITION_MIN_PER_THREAD)
+        threads = n / PARTITION_MIN_PER_THREAD;
+    if (threads > 1) {
+        partition_parallel(arr, n, splitters, bucket_count, offsets, threads);
+    } else if (bucket_count == 3 && splitters[1] != INT_MIN && splitters[0] <= splitters[1] - 1) {
+        // Три корзины – одно трёхчастное разбиение по паре опорных
+        int l, r;
+        hmm_partition_by_pivots(arr, 0, n - 1, splitters[0], splitters[1] - 1, &l, &r);
+        offsets[0] = 0;
+        offsets[1] = l;
+        offsets[2] = r + 1;
+        offsets[3] = n;
+    } else {
+        partition_serial(arr, n, splitters, bucket_count, offsets);
+    }
+    free(own);
+}
@@ -0,0 +1,184 @@
+/*
+ * min_max_sort_patterns.c
+ *
+ * Генераторы входных распределений для тестов и замеров, включая известные
+ * "убийственные" для быстрой сортировки шаблоны и противника, построенного
+ * под фиксированные позиции выборки опорных в hmm_select_lower_pivot/hmm_select_upper_pivot.
+ */
+
+#include "min_max_sort.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Генератор splitmix64
+static uint64_t pattern_next(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Медиана из 3 или 5 значений
+static int median_value(int v[], int count) {
+    for (int i = 1; i < count; i++) {
+        int key = v[i], j = i - 1;
+        while (j >= 0 && v[j] > key) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = key;
+    }
+    return v[count / 2];
+}
+
+// Противник для фиксированной выборки: значения назначаются лениво. Элементы
+// на позициях выборки нижнего опорного получают наименьшие свободные значения,
+// верхнего – наибольшие, остальные ("газ") лежат между ними. Разбиение
+// моделируется точно, и процесс повторяется для наибольшей части, так что
+// каждый уровень отщепляет лишь несколько элементов. Построение само по себе
+// занимает O(n^2), поэтому разумные размеры – до ~10^5
+static void generate_pivot_killer(int arr[], int n) {
+    int *pos = malloc(n * sizeof(int));     // pos[i] – исходный номер элемента на позиции i
+    int *rank = malloc(n * sizeof(int));    // назначенный ранг элемента или -1
+    int *cls = malloc(n * sizeof(int));
+    if (!pos || !rank || !cls) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_generate_pattern.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < n; i++) {
+        pos[i] = i;
+        rank[i] = -1;
+    }
+    int next_low = 0, next_high = n - 1;
+    int left = 0, right = n - 1;
+    int threshold = hmm_tuning_profile.int_params.insertion_threshold;
+    int median5 = hmm_tuning_profile.int_params.median5_threshold;
+
+    while (right - left + 1 > threshold && next_low <= next_high) {
+        int s = right - left + 1;
+        int lower_idx[5], upper_idx[5], count;
+        if (s < median5) {
+            count = 3;
+            lower_idx[0] = left; lower_idx[1] = left + s / 4; lower_idx[2] = left + s / 2;
+            upper_idx[0] = left + s / 2; upper_idx[1] = left + (3 * s) / 4; upper_idx[2] = right;
+        } else {
+            count = 5;
+            lower_idx[0] = left; lower_idx[1] = left + s / 8; lower_idx[2] = left + s / 4;
+            lower_idx[3] = left + (3 * s) / 8; lower_idx[4] = left + s / 2;
+            upper_idx[0] = left + s / 2; upper_idx[1] = left + (5 * s) / 8; upper_idx[2] = left + (3 * s) / 4;
+            upper_idx[3] = left + (7 * s) / 8; upper_idx[4] = right;
+        }
+        int lv[5], uv[5];
+        for (int i = 0; i < count; i++) {
+            if (rank[pos[lower_idx[i]]] < 0 && next_low <= next_high)
+                rank[pos[lower_idx[i]]] = next_low++;
+            lv[i] = rank[pos[lower_idx[i]]];
+        }
+        for (int i = 0; i < count; i++) {
+            if (rank[pos[upper_idx[i]]] < 0 && next_low <= next_high)
+                rank[pos[upper_idx[i]]] = next_high--;
+            uv[i] = rank[pos[upper_idx[i]]];
+        }
+        if (median_value(lv, count) < 0 || median_value(uv, count) < 0)
+            break;
+        int lower = median_value(lv, count), upper = median_value(uv, count);
+        if (lower > upper) {
+            int t = lower;
+            lower = upper;
+            upper = t;
+        }
+        // Класс элемента: 0 – меньше нижнего, 2 – больше верхнего, 1 – между;
+        // свободные значения лежат в [next_low, next_high]
+        for (int i = left; i <= right; i++) {
+            int r = rank[pos[i]];
+            if (r < 0)
+                cls[i] = (lower > next_high) ? 0 : (upper < next_low) ? 2 : 1;
+            else
+                cls[i] = (r < lower) ? 0 : (r > upper) ? 2 : 1;
+        }
+        int l = left, r = right;
+        for (int i = left; i <= r;) {
+            if (cls[i] == 0) {
+                int t = pos[i]; pos[i] = pos[l]; pos[l] = t;
+                t = cls[i]; cls[i] = cls[l]; cls[l] = t;
+                l++;
+                i++;
+            } else if (cls[i] == 2) {
+                int t = pos[i]; pos[i] = pos[r]; pos[r] = t;
+                t = cls[i]; cls[i] = cls[r]; cls[r] = t;
+                r--;
+            } else {
+                i++;
+            }
+        }
+        if (l - left >= r - l + 1 && l - left >= right - r) {
+            right = l - 1;
+        } else if (r - l + 1 >= right - r) {
+            left = l;
+            right = r;
+        } else {
+            left = r + 1;
+        }
+    }
+    // Оставшийся "газ" получает значения по порядку позиций
+    for (int i = 0; i < n; i++)
+        if (rank[pos[i]] < 0)
+            rank[pos[i]] = next_low++;
+    // Значения разрежены, чтобы диапазон превышал n и не включалась сортировка подсчётом
+    for (int i = 0; i < n; i++)
+        arr[i] = 4 * (rank[i] - n / 2);
+    free(cls);
+    free(rank);
+    free(pos);
+}
+
+// Заполнение arr[0..n-1] распределением kind (HMM_PATTERN_*)
+void hmm_generate_pattern(int arr[], int n, int kind, unsigned long long seed) {
+    hmm_tuning_init();
+    uint64_t state = seed;
+    switch (kind) {
+    case HMM_PATTERN_SORTED:
+        for (int i = 0; i < n; i++)
+            arr[i] = i;
+        break;
+    case HMM_PATTERN_REVERSE:
+        for (int i = 0; i < n; i++)
+            arr[i] = n - i;
+        break;
+    case HMM_PATTERN_ORGAN_PIPE:
+        for (int i = 0; i < n; i++)
+            arr[i] = (i < n / 2) ? i : n - i;
+        break;
+    case HMM_PATTERN_SAWTOOTH:
+        for (int i = 0; i < n; i++)
+            arr[i] = i % 1024;
+        break;
+    case HMM_PATTERN_ALL_EQUAL:
+        for (int i = 0; i < n; i++)
+            arr[i] = 42;
+        break;
+    case HMM_PATTERN_FEW_UNIQUE:
+        for (int i = 0; i < n; i++)
+            arr[i] = (int)(pattern_next(&state) % 8) * 1000003;
+        break;
+    case HMM_PATTERN_MEDIAN3_KILLER: {
+        // Шаблон Мюссера против медианы из трёх
+        int k = n / 2;
+        for (int i = 0; i < k; i++) {
+            arr[i] = (i % 2 == 0) ? i + 1 : k + i + (k % 2 == 0 ? 0 : 1);
+            arr[k + i] = 2 * (i + 1);
+        }
+        if (n % 2)
+            arr[n - 1] = n;
+        break;
+    }
+    case HMM_PATTERN_PIVOT_KILLER:
+        generate_pivot_killer(arr, n);
+        break;
+    default:
+        for (int i = 0; i < n; i++)
+            arr[i] = (int)(pattern_next(&state) >> 33);
+        break;
+    }
+}
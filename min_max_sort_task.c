@@ -0,0 +1,426 @@
+/*
+ * min_max_sort_task.c
+ *
+ * Кооперативная гибридная сортировка Min-Max для int: явная машина состояний
+ * над стеком сегментов, которая за один вызов hmm_sort_task_step выполняет
+ * ограниченный по времени объём работы и возвращает управление циклу событий.
+ * Разбиение и запасная сортировка слиянием тоже продолжаются с места остановки.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "min_max_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TASK_CHUNK 4096
+
+enum {
+    TASK_PRESCAN,    // поиск границ значений всего массива
+    TASK_NEXT,       // взять следующий сегмент
+    TASK_PARTITION,  // идёт разбиение текущего сегмента
+    TASK_MERGE,      // идёт запасная сортировка слиянием текущего сегмента
+    TASK_COUNT,      // подсчёт значений узкого по диапазону сегмента
+    TASK_SPREAD,     // запись сегмента по гистограмме
+    TASK_DONE
+};
+
+// Состояния слияния пары серий (поле merging)
+enum {
+    MERGE_IDLE,      // между парами
+    MERGE_COPY,      // левая половина копируется в буфер
+    MERGE_RUN        // идёт слияние буфера с правой половиной
+};
+
+static long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void hmm_sort_task_init(hmm_sort_task *task, int arr[], int n) {
+    hmm_tuning_init();
+    memset(task, 0, sizeof(*task));
+    task->arr = arr;
+    task->n = n;
+    task->phase = (n > 1) ? TASK_PRESCAN : TASK_DONE;
+    task->left = 0;
+    task->right = n - 1;
+    if (n > 1)
+        task->min_value = task->max_value = arr[0];
+    task->max_depth = hmm_depth_limit(n);
+
+    // Оценка полного объёма работы: n элементов на предпросмотр и на каждый
+    // уровень разбиения
+    long long levels = 2;
+    for (long long s = n; s > hmm_tuning_profile.int_params.insertion_threshold; s /= 3)
+        levels++;
+    task->work_estimate = (long long)n * levels;
+}
+
+// Переход к следующему отложенному сегменту
+static void task_pop(hmm_sort_task *t) {
+    if (t->top == 0) {
+        t->phase = TASK_DONE;
+        return;
+    }
+    t->top--;
+    t->left = t->stack_left[t->top];
+    t->right = t->stack_right[t->top];
+    t->min_value = t->stack_min[t->top];
+    t->max_value = t->stack_max[t->top];
+    t->depth = t->stack_depth[t->top];
+    t->phase = TASK_NEXT;
+}
+
+// Продолжение поиска min/max на не более чем TASK_CHUNK элементов
+static void task_prescan_chunk(hmm_sort_task *t) {
+    int *arr = t->arr;
+    int i = t->i, end = t->i + TASK_CHUNK < t->n ? t->i + TASK_CHUNK : t->n;
+    int min_value = t->min_value, max_value = t->max_value;
+    for (; i < end; i++) {
+        if (arr[i] < min_value)
+            min_value = arr[i];
+        if (arr[i] > max_value)
+            max_value = arr[i];
+    }
+    t->work_done += end - t->i;
+    t->i = i;
+    t->min_value = min_value;
+    t->max_value = max_value;
+    if (i == t->n)
+        t->phase = TASK_NEXT;
+}
+
+// Начало разбиения: выбор опорных, как в hmm_partition_min_max. Опорное,
+// совпавшее с границей значений сегмента, сдвигается внутрь (как в
+// hybrid_min_max_sort_serial), чтобы крайняя часть не оказалась пустой
+static void task_start_partition(hmm_sort_task *t) {
+    int *arr = t->arr;
+    int left = t->left, right = t->right, segment_size = right - left + 1;
+    int i_med_low = hmm_select_lower_pivot(arr, left, right, segment_size);
+    int i_med_high = hmm_select_upper_pivot(arr, left, right, segment_size);
+    if (arr[i_med_low] > arr[i_med_high]) {
+        int temp = arr[i_med_low];
+        arr[i_med_low] = arr[i_med_high];
+        arr[i_med_high] = temp;
+    }
+    t->lower = arr[i_med_low];
+    t->upper = arr[i_med_high];
+    hmm_nudge_pivots(&t->lower, &t->upper, t->min_value, t->max_value);
+    t->i = t->l = left;
+    t->r = right;
+    t->phase = TASK_PARTITION;
+}
+
+// Длина блоков вставок запасного слияния – порог вставок профиля,
+// как в merge_sort_scratch
+static int task_merge_block(void) {
+    int block = hmm_tuning_profile.int_params.insertion_threshold;
+    return block < 2 ? 2 : block;
+}
+
+// Начало запасной сортировки слиянием: блоки сортируются вставками
+// по мере продвижения (width == 0), затем сливаются попарно
+static void task_start_merge(hmm_sort_task *t) {
+    int size = t->right - t->left + 1;
+    t->buf = malloc(size * sizeof(int));
+    if (!t->buf) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_sort_task_step.\n");
+        exit(EXIT_FAILURE);
+    }
+    t->width = 0;
+    t->pos = t->left;
+    t->merging = MERGE_IDLE;
+    t->phase = TASK_MERGE;
+}
+
+// Начало сортировки подсчётом сегмента, диапазон значений которого меньше
+// длины (как hmm_counting_sort_range в hybrid_min_max_sort_serial):
+// buf – гистограмма, pos – позиция прохода, mi – текущее значение
+static void task_start_count(hmm_sort_task *t) {
+    long long range = (long long)t->max_value - t->min_value + 1;
+    t->buf = calloc((size_t)range, sizeof(int));
+    if (!t->buf) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_sort_task_step.\n");
+        exit(EXIT_FAILURE);
+    }
+    t->pos = t->left;
+    t->phase = TASK_COUNT;
+}
+
+// Продолжение подсчёта на не более чем TASK_CHUNK элементов
+static void task_count_chunk(hmm_sort_task *t) {
+    int *arr = t->arr, *count = t->buf;
+    int end = (t->right - t->pos + 1 < TASK_CHUNK) ? t->right + 1 : t->pos + TASK_CHUNK;
+    for (int i = t->pos; i < end; i++)
+        count[(long long)arr[i] - t->min_value]++;
+    t->work_done += end - t->pos;
+    t->pos = end;
+    if (end > t->right) {
+        t->pos = t->left;
+        t->mi = 0;
+        t->phase = TASK_SPREAD;
+    }
+}
+
+// Запись по гистограмме: не больше limit шагов (записанный элемент или
+// пропущенное пустое значение – шаг). Возвращает число сделанных шагов
+static int task_spread(hmm_sort_task *t, int limit) {
+    int *arr = t->arr, *count = t->buf;
+    int range = t->max_value - t->min_value + 1;
+    int pos = t->pos, v = t->mi, steps = 0;
+    while (v < range && steps < limit) {
+        if (count[v] == 0) {
+            v++;
+            steps++;
+            continue;
+        }
+        int c = count[v] < limit - steps ? count[v] : limit - steps;
+        int value = t->min_value + v;
+        for (int i = 0; i < c; i++)
+            arr[pos + i] = value;
+        pos += c;
+        count[v] -= c;
+        steps += c;
+    }
+    t->pos = pos;
+    t->mi = v;
+    return steps;
+}
+
+static void task_spread_chunk(hmm_sort_task *t) {
+    t->work_done += task_spread(t, TASK_CHUNK);
+    if (t->mi == t->max_value - t->min_value + 1) {
+        free(t->buf);
+        t->buf = NULL;
+        t->done_elems += t->right - t->left + 1;
+        task_pop(t);
+    }
+}
+
+// Продолжение разбиения на не более чем TASK_CHUNK элементов
+static void task_partition_chunk(hmm_sort_task *t) {
+    int *arr = t->arr;
+    int i = t->i, l = t->l, r = t->r;
+    int lowerPivot = t->lower, upperPivot = t->upper;
+    int limit = TASK_CHUNK;
+    while (i <= r && limit-- > 0) {
+        int x = arr[i];
+        if (x < lowerPivot) {
+            arr[i] = arr[l];
+            arr[l] = x;
+            l++;
+            i++;
+        } else if (x > upperPivot) {
+            arr[i] = arr[r];
+            arr[r] = x;
+            r--;
+        } else {
+            i++;
+        }
+    }
+    t->work_done += TASK_CHUNK - (limit > 0 ? limit : 0);
+    t->i = i;
+    t->l = l;
+    t->r = r;
+    if (i <= r)
+        return;
+
+    int left = t->left, right = t->right;
+    if (l == left || r == right) {
+        task_start_merge(t);
+        return;
+    }
+    // Две большие части – в стек, продолжаем с наименьшей (как в hybrid_min_max_sort_serial)
+    int lo[3] = { left, l, r + 1 }, hi[3] = { l - 1, r, right };
+    int vmin[3] = { t->min_value, lowerPivot, upperPivot + 1 };
+    int vmax[3] = { lowerPivot - 1, upperPivot, t->max_value };
+    int order[3];
+    hmm_part_order(lo, hi, order);
+    for (int q = 0; q < 2; q++) {
+        int p = order[q];
+        t->stack_left[t->top] = lo[p];
+        t->stack_right[t->top] = hi[p];
+        t->stack_min[t->top] = vmin[p];
+        t->stack_max[t->top] = vmax[p];
+        t->stack_depth[t->top++] = t->depth + 1;
+    }
+    int small = order[2];
+    t->left = lo[small];
+    t->right = hi[small];
+    t->min_value = vmin[small];
+    t->max_value = vmax[small];
+    t->depth++;
+    t->phase = TASK_NEXT;
+}
+
+// Продолжение сортировки слиянием на не более чем TASK_CHUNK элементов
+static void task_merge_chunk(hmm_sort_task *t) {
+    int *arr = t->arr;
+    int left = t->left, right = t->right;
+
+    if (t->width == 0) {
+        int block = task_merge_block();
+        int hi = t->pos + block - 1;
+        if (hi > right)
+            hi = right;
+        hmm_insertion_sort(arr, t->pos, hi);
+        t->work_done += hi - t->pos + 1;
+        t->pos += block;
+        if (t->pos > right) {
+            t->width = block;
+            t->pos = left;
+        }
+        return;
+    }
+
+    if (t->merging == MERGE_IDLE) {
+        // Пропуск пар, у которых нет правой половины: хвост уже упорядочен,
+        // но переход на следующий уровень тоже считается работой
+        if (t->pos + t->width > right) {
+            t->work_done += right - t->pos + 1;
+            t->width *= 2;
+            t->pos = left;
+            if (t->width >= right - left + 1) {
+                free(t->buf);
+                t->buf = NULL;
+                t->done_elems += right - left + 1;
+                task_pop(t);
+            }
+            return;
+        }
+        // Левая половина копируется в буфер (частями, mi – скопировано),
+        // выход пишется на её место
+        t->mi = 0;
+        t->mn1 = t->width;
+        t->mj = t->pos + t->width;
+        t->mend = t->pos + 2 * t->width - 1;
+        if (t->mend > right)
+            t->mend = right;
+        t->mk = t->pos;
+        t->merging = MERGE_COPY;
+    }
+
+    if (t->merging == MERGE_COPY) {
+        int c = (t->mn1 - t->mi < TASK_CHUNK) ? t->mn1 - t->mi : TASK_CHUNK;
+        memcpy(&t->buf[t->mi], &arr[t->pos + t->mi], c * sizeof(int));
+        t->mi += c;
+        t->work_done += c;
+        if (t->mi == t->mn1) {
+            t->mi = 0;
+            t->merging = MERGE_RUN;
+        }
+        return;
+    }
+
+    int i = t->mi, j = t->mj, k = t->mk, n1 = t->mn1, end = t->mend;
+    int *buf = t->buf;
+    int limit = TASK_CHUNK;
+    while (i < n1 && j <= end && limit > 0) {
+        arr[k++] = (buf[i] <= arr[j]) ? buf[i++] : arr[j++];
+        limit--;
+    }
+    // Правая половина кончилась – остаток левой дописывается в пределах того же лимита
+    if (i < n1 && j > end && limit > 0) {
+        int c = (n1 - i < limit) ? n1 - i : limit;
+        memcpy(&arr[k], &buf[i], c * sizeof(int));
+        k += c;
+        i += c;
+        limit -= c;
+    }
+    t->work_done += TASK_CHUNK - limit;
+    t->mi = i;
+    t->mj = j;
+    t->mk = k;
+    if (i == n1) {
+        // Остаток правой половины уже на месте
+        t->merging = MERGE_IDLE;
+        t->pos += 2 * t->width;
+    }
+}
+
+// Одна единица работы (не больше TASK_CHUNK элементов)
+static void task_unit(hmm_sort_task *t) {
+    switch (t->phase) {
+    case TASK_PRESCAN:
+        task_prescan_chunk(t);
+        break;
+    case TASK_NEXT: {
+        int segment_size = t->right - t->left + 1;
+        if (t->min_value == t->max_value) {
+            // Все значения равны
+            t->done_elems += segment_size;
+            t->work_done += 1;
+            task_pop(t);
+        } else if (segment_size <= hmm_get_adaptive_threshold(segment_size)) {
+            hmm_insertion_sort(t->arr, t->left, t->right);
+            t->done_elems += segment_size;
+            t->work_done += segment_size;
+            task_pop(t);
+        } else if ((long long)t->max_value - t->min_value < segment_size) {
+            task_start_count(t);
+        } else if (t->depth >= t->max_depth) {
+            task_start_merge(t);
+        } else {
+            task_start_partition(t);
+        }
+        break;
+    }
+    case TASK_PARTITION:
+        task_partition_chunk(t);
+        break;
+    case TASK_MERGE:
+        task_merge_chunk(t);
+        break;
+    case TASK_COUNT:
+        task_count_chunk(t);
+        break;
+    case TASK_SPREAD:
+        task_spread_chunk(t);
+        break;
+    }
+}
+
+// Выполняет работу в пределах budget_ns наносекунд (минимум одну единицу).
+// Возвращает 1, когда сортировка завершена (или отменена)
+int hmm_sort_task_step(hmm_sort_task *task, long long budget_ns) {
+    if (task->phase == TASK_DONE)
+        return 1;
+    long long deadline = now_ns() + budget_ns;
+    do {
+        // Часы опрашиваются не чаще, чем раз в TASK_CHUNK элементов работы
+        long long mark = task->work_done;
+        do {
+            task_unit(task);
+        } while (task->phase != TASK_DONE && task->work_done - mark < TASK_CHUNK);
+    } while (task->phase != TASK_DONE && now_ns() < deadline);
+    return task->phase == TASK_DONE;
+}
+
+// Отмена: массив остаётся перестановкой исходных элементов. Если прервано
+// слияние, содержимое буфера возвращается на свободные позиции; если прервана
+// запись по гистограмме, она дописывается до конца
+void hmm_sort_task_cancel(hmm_sort_task *task) {
+    if (task->phase == TASK_DONE)
+        return;
+    if (task->phase == TASK_SPREAD)
+        task_spread(task, task->right - task->pos + 1 + task->max_value - task->min_value + 1);
+    if (task->phase == TASK_MERGE && task->merging == MERGE_RUN)
+        memcpy(&task->arr[task->mk], &task->buf[task->mi], (task->mn1 - task->mi) * sizeof(int));
+    free(task->buf);
+    task->buf = NULL;
+    task->cancelled = 1;
+    task->phase = TASK_DONE;
+}
+
+// Оценка доли выполненной работы в диапазоне [0, 1]
+double hmm_sort_task_progress(const hmm_sort_task *task) {
+    if (task->phase == TASK_DONE)
+        return task->cancelled ? (double)task->done_elems / (task->n > 0 ? task->n : 1) : 1.0;
+    double by_work = (double)task->work_done / (double)task->work_estimate;
+    double by_elems = (double)task->done_elems / task->n;
+    double p = by_work > by_elems ? by_work : by_elems;
+    return p < 0.99 ? p : 0.99;
+}
@@ -0,0 +1,161 @@
+/*
+ * min_max_sort_trace.c
+ *
+ * Трассировка сегментов сортировки во временную шкалу формата Chrome trace
+ * (chrome://tracing, Perfetto). События пишутся только в сборке с -DHMM_TRACE:
+ * у каждого потока своё кольцо событий, запись в него не требует блокировок
+ * (один писатель, индекс публикуется атомарно), при переполнении старые
+ * события затираются. Без HMM_TRACE вызовы в драйверах не компилируются,
+ * а hmm_trace_dump записывает пустую трассу.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "min_max_sort.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TRACE_RING_SIZE (1 << 16)      // событий на поток, степень двойки
+#define TRACE_MAX_THREADS 256
+
+typedef struct {
+    long long begin_ns, end_ns;
+    int size, lower, upper;
+    unsigned char part, kernel;
+} trace_event;
+
+typedef struct {
+    int tid;
+    unsigned long long head;           // число записанных событий
+    trace_event events[TRACE_RING_SIZE];
+} trace_ring;
+
+int hmm_trace_threshold = 4096;
+
+static trace_ring *trace_rings[TRACE_MAX_THREADS];
+static int trace_ring_count;
+static __thread trace_ring *trace_my_ring;
+static __thread int trace_no_ring;     // потоков больше TRACE_MAX_THREADS – события теряются
+
+static pthread_once_t trace_once = PTHREAD_ONCE_INIT;
+
+// Порог из переменной окружения HMM_TRACE_THRESHOLD
+static void trace_load_threshold(void) {
+    const char *s = getenv("HMM_TRACE_THRESHOLD");
+    if (s && *s)
+        hmm_trace_threshold = atoi(s);
+}
+
+long long hmm_trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Начало сегмента: время, если сегмент не меньше порога, иначе 0. Порог из
+// окружения читается однократно при первом вызове, как профиль в hmm_tuning_init
+long long hmm_trace_begin(int size) {
+    pthread_once(&trace_once, trace_load_threshold);
+    return (size >= hmm_trace_threshold) ? hmm_trace_now() : 0;
+}
+
+// Кольцо текущего потока; создаётся при первом событии
+static trace_ring *trace_ring_get(void) {
+    if (trace_my_ring || trace_no_ring)
+        return trace_my_ring;
+    int id = __atomic_fetch_add(&trace_ring_count, 1, __ATOMIC_RELAXED);
+    trace_ring *ring = (id < TRACE_MAX_THREADS) ? calloc(1, sizeof(trace_ring)) : NULL;
+    if (!ring) {
+        trace_no_ring = 1;
+        return NULL;
+    }
+    ring->tid = id + 1;
+    __atomic_store_n(&trace_rings[id], ring, __ATOMIC_RELEASE);
+    trace_my_ring = ring;
+    return ring;
+}
+
+// Событие сегмента: время от begin_ns до текущего момента
+void hmm_trace_record(long long begin_ns, int size, int lower, int upper, int part, int kernel) {
+    long long end_ns = hmm_trace_now();
+    trace_ring *ring = trace_ring_get();
+    if (!ring)
+        return;
+    unsigned long long head = ring->head;
+    trace_event *e = &ring->events[head & (TRACE_RING_SIZE - 1)];
+    e->begin_ns = begin_ns;
+    e->end_ns = end_ns;
+    e->size = size;
+    e->lower = lower;
+    e->upper = upper;
+    e->part = (unsigned char)part;
+    e->kernel = (unsigned char)kernel;
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+// Очистка колец; вызывается, когда сортировки не выполняются
+void hmm_trace_reset(void) {
+    int count = __atomic_load_n(&trace_ring_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count && i < TRACE_MAX_THREADS; i++) {
+        trace_ring *ring = __atomic_load_n(&trace_rings[i], __ATOMIC_ACQUIRE);
+        if (ring)
+            __atomic_store_n(&ring->head, 0, __ATOMIC_RELEASE);
+    }
+}
+
+// Запись накопленных событий в path как JSON Chrome trace: события "X"
+// (полные, с длительностью) с аргументами size/lower/upper/part и метаданные
+// с именами потоков. Возвращает 0 при успехе
+int hmm_trace_dump(const char *path) {
+    static const char *part_names[] = { "low", "mid", "high", "root" };
+    static const char *kernel_names[] = {
+        "insertion", "counting", "partition", "merge", "histogram", "scatter", "bucket"
+    };
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+    int count = __atomic_load_n(&trace_ring_count, __ATOMIC_ACQUIRE);
+    if (count > TRACE_MAX_THREADS)
+        count = TRACE_MAX_THREADS;
+
+    // Начало шкалы – самое раннее сохранённое событие
+    long long base = -1;
+    for (int i = 0; i < count; i++) {
+        trace_ring *ring = __atomic_load_n(&trace_rings[i], __ATOMIC_ACQUIRE);
+        if (!ring)
+            continue;
+        unsigned long long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        unsigned long long first = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0;
+        for (unsigned long long k = first; k < head; k++) {
+            long long t = ring->events[k & (TRACE_RING_SIZE - 1)].begin_ns;
+            if (base < 0 || t < base)
+                base = t;
+        }
+    }
+
+    fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    int first_event = 1;
+    for (int i = 0; i < count; i++) {
+        trace_ring *ring = __atomic_load_n(&trace_rings[i], __ATOMIC_ACQUIRE);
+        if (!ring)
+            continue;
+        fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                   "\"args\":{\"name\":\"hmm worker %d\"}}",
+                first_event ? "" : ",\n", ring->tid, ring->tid);
+        first_event = 0;
+        unsigned long long head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        unsigned long long first = (head > TRACE_RING_SIZE) ? head - TRACE_RING_SIZE : 0;
+        for (unsigned long long k = first; k < head; k++) {
+            const trace_event *e = &ring->events[k & (TRACE_RING_SIZE - 1)];
+            fprintf(f, ",\n{\"name\":\"%s\",\"cat\":\"hmm\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                       "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"size\":%d,\"lower\":%d,\"upper\":%d,"
+                       "\"part\":\"%s\"}}",
+                    kernel_names[e->kernel], ring->tid,
+                    (e->begin_ns - base) / 1000.0, (e->end_ns - e->begin_ns) / 1000.0,
+                    e->size, e->lower, e->upper, part_names[e->part]);
+        }
+    }
+    fprintf(f, "\n]}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
@@ -0,0 +1,250 @@
+/*
+ * min_max_sort_tune.c
+ *
+ * Калибровка порогов гибридной сортировки Min-Max под текущую машину:
+ * замер ядер для каждого типа ключа, сохранение и загрузка профиля,
+ * генерация заголовка hmm_tuned.h с константами для сборки
+ * с -DHMM_USE_TUNED_HEADER.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "min_max_sort.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TUNE_REPEATS 5
+#define TUNE_DEFAULT_CACHE (256 * 1024)
+
+/* ==================== Профиль: загрузка и сохранение ==================== */
+
+// Поле профиля по имени ключа ("int.insertion_threshold" и т.п.) и допустимый
+// диапазон его значений: слишком большой порог вставок делает сортировку
+// квадратичной, поэтому значения из файла прижимаются к диапазону
+typedef struct {
+    const char *name;
+    size_t offset;
+    int min, max;
+} tuning_field_info;
+
+#define TUNE_INSERTION_MIN 4
+#define TUNE_INSERTION_MAX 256
+#define TUNE_MEDIAN5_MIN 16
+#define TUNE_MEDIAN5_MAX (1 << 20)
+
+static const tuning_field_info *tuning_field(const char *key) {
+    static const tuning_field_info fields[] = {
+        { "int.insertion_threshold", offsetof(hmm_tuning, int_params.insertion_threshold),
+          TUNE_INSERTION_MIN, TUNE_INSERTION_MAX },
+        { "int.median5_threshold", offsetof(hmm_tuning, int_params.median5_threshold),
+          TUNE_MEDIAN5_MIN, TUNE_MEDIAN5_MAX },
+        { "double.insertion_threshold", offsetof(hmm_tuning, double_params.insertion_threshold),
+          TUNE_INSERTION_MIN, TUNE_INSERTION_MAX },
+        { "double.median5_threshold", offsetof(hmm_tuning, double_params.median5_threshold),
+          TUNE_MEDIAN5_MIN, TUNE_MEDIAN5_MAX },
+        { "qsort.insertion_threshold", offsetof(hmm_tuning, qsort_params.insertion_threshold),
+          TUNE_INSERTION_MIN, TUNE_INSERTION_MAX },
+        { "qsort.median5_threshold", offsetof(hmm_tuning, qsort_params.median5_threshold),
+          TUNE_MEDIAN5_MIN, TUNE_MEDIAN5_MAX },
+    };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+        if (strcmp(fields[i].name, key) == 0)
+            return &fields[i];
+    return NULL;
+}
+
+// Разбор файла профиля в формате "ключ = значение"; строки с '#' – комментарии.
+// Неизвестные ключи и неположительные значения не меняют текущий профиль,
+// остальные значения прижимаются к допустимому диапазону поля
+static int tuning_load_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f)
+        return -1;
+    hmm_tuning t = hmm_tuning_profile;
+    char line[256], key[128];
+    int value;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || sscanf(line, " %127[^= ] = %d", key, &value) != 2)
+            continue;
+        const tuning_field_info *field = tuning_field(key);
+        if (!field || value <= 0)
+            continue;
+        if (value < field->min)
+            value = field->min;
+        if (value > field->max)
+            value = field->max;
+        *(int *)((char *)&t + field->offset) = value;
+    }
+    fclose(f);
+    hmm_tuning_profile = t;
+    return 0;
+}
+
+// Профиль из HMM_TUNING_FILE подхватывается при первой сортировке, а не при
+// загрузке библиотеки (в том числе через LD_PRELOAD-прослойку). Ошибка
+// загрузки сообщается только при HMM_TUNING_VERBOSE
+static pthread_once_t tuning_once = PTHREAD_ONCE_INIT;
+
+static void tuning_load_from_env(void) {
+    const char *path = getenv("HMM_TUNING_FILE");
+    if (!path || !*path || tuning_load_file(path) == 0)
+        return;
+    const char *verbose = getenv("HMM_TUNING_VERBOSE");
+    if (verbose && *verbose && strcmp(verbose, "0") != 0)
+        fprintf(stderr, "Не удалось загрузить профиль настройки %s.\n", path);
+}
+
+void hmm_tuning_init(void) {
+    pthread_once(&tuning_once, tuning_load_from_env);
+}
+
+// Явная загрузка профиля; применяется поверх профиля из HMM_TUNING_FILE
+int hmm_tuning_load(const char *path) {
+    hmm_tuning_init();
+    return tuning_load_file(path);
+}
+
+int hmm_tuning_save(const char *path) {
+    hmm_tuning_init();
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+    const hmm_tuning *t = &hmm_tuning_profile;
+    fprintf(f, "# Профиль гибридной сортировки Min-Max (hmm_tuning_calibrate)\n");
+    fprintf(f, "int.insertion_threshold = %d\n", t->int_params.insertion_threshold);
+    fprintf(f, "int.median5_threshold = %d\n", t->int_params.median5_threshold);
+    fprintf(f, "double.insertion_threshold = %d\n", t->double_params.insertion_threshold);
+    fprintf(f, "double.median5_threshold = %d\n", t->double_params.median5_threshold);
+    fprintf(f, "qsort.insertion_threshold = %d\n", t->qsort_params.insertion_threshold);
+    fprintf(f, "qsort.median5_threshold = %d\n", t->qsort_params.median5_threshold);
+    return fclose(f);
+}
+
+// Заголовок с константами профиля для сборки с -DHMM_USE_TUNED_HEADER
+int hmm_tuning_write_header(const char *path) {
+    hmm_tuning_init();
+    FILE *f = fopen(path, "w");
+    if (!f)
+        return -1;
+    const hmm_tuning *t = &hmm_tuning_profile;
+    fprintf(f, "/* Сгенерировано hmm_tuning_write_header – не редактировать вручную */\n");
+    fprintf(f, "#ifndef HMM_TUNED_H\n#define HMM_TUNED_H\n\n");
+    fprintf(f, "#define HMM_TUNED_INT_INSERTION_THRESHOLD %d\n", t->int_params.insertion_threshold);
+    fprintf(f, "#define HMM_TUNED_INT_MEDIAN5_THRESHOLD %d\n", t->int_params.median5_threshold);
+    fprintf(f, "#define HMM_TUNED_DOUBLE_INSERTION_THRESHOLD %d\n", t->double_params.insertion_threshold);
+    fprintf(f, "#define HMM_TUNED_DOUBLE_MEDIAN5_THRESHOLD %d\n", t->double_params.median5_threshold);
+    fprintf(f, "#define HMM_TUNED_QSORT_INSERTION_THRESHOLD %d\n", t->qsort_params.insertion_threshold);
+    fprintf(f, "#define HMM_TUNED_QSORT_MEDIAN5_THRESHOLD %d\n", t->qsort_params.median5_threshold);
+    fprintf(f, "\n#endif /* HMM_TUNED_H */\n");
+    return fclose(f);
+}
+
+/* ==================== Калибровка ==================== */
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int compare_int_tune(const void *a, const void *b) {
+    int x = *(const int *)a, y = *(const int *)b;
+    return (x > y) - (x < y);
+}
+
+enum { TUNE_INT, TUNE_DOUBLE, TUNE_QSORT };
+
+// Лучшее из TUNE_REPEATS время сортировки одной и той же случайной выборки
+static double time_kernel(int kind, const int src[], int n, void *work) {
+    double best = 1e30;
+    for (int rep = 0; rep < TUNE_REPEATS; rep++) {
+        if (kind == TUNE_DOUBLE)
+            for (int i = 0; i < n; i++)
+                ((double *)work)[i] = src[i];
+        else
+            memcpy(work, src, n * sizeof(int));
+        double start = now_sec();
+        if (kind == TUNE_INT)
+            hybrid_min_max_sort_serial(work, 0, n - 1, 2);
+        else if (kind == TUNE_DOUBLE)
+            hybrid_min_max_sort_serial_double(work, 0, n - 1, 2);
+        else
+            hmm_qsort(work, n, sizeof(int), compare_int_tune);
+        double t = now_sec() - start;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+// Перебор значения одного порога при фиксированных остальных
+static void tune_field(int kind, int *field, const int candidates[], int count,
+                       const int src[], int n, void *work, const char *name, int verbose) {
+    int best_value = *field;
+    double best_time = 1e30;
+    for (int c = 0; c < count; c++) {
+        *field = candidates[c];
+        double t = time_kernel(kind, src, n, work);
+        if (verbose)
+            printf("  %-28s %5d: %.6f сек\n", name, candidates[c], t);
+        if (t < best_time) {
+            best_time = t;
+            best_value = candidates[c];
+        }
+    }
+    *field = best_value;
+}
+
+// Размер выборки для калибровки – несколько объёмов кэша L2, чтобы
+// пороги подбирались на типичных для рекурсии размерах сегментов
+static int calibration_size(void) {
+    long cache = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    cache = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+    if (cache <= 0)
+        cache = TUNE_DEFAULT_CACHE;
+    return (int)(4 * cache / sizeof(int));
+}
+
+// Калибровка всех порогов профиля на текущей машине
+void hmm_tuning_calibrate(int verbose) {
+    hmm_tuning_init();
+    static const int insertion_candidates[] = { 8, 12, 16, 24, 32, 48, 64, 96, 128 };
+    static const int median5_candidates[] = { 32, 64, 128, 256, 512, 1024 };
+    static const int qsort_candidates[] = { 4, 8, 12, 16, 24, 32 };
+    int n = calibration_size();
+    int *src = malloc(n * sizeof(int));
+    double *work = malloc(n * sizeof(double));
+    if (!src || !work) {
+        fprintf(stderr, "Ошибка выделения памяти в hmm_tuning_calibrate.\n");
+        exit(EXIT_FAILURE);
+    }
+    srand(12345);
+    for (int i = 0; i < n; i++)
+        src[i] = rand();
+    if (verbose)
+        printf("Калибровка на %d элементах\n", n);
+
+    hmm_tuning *t = &hmm_tuning_profile;
+    int ni = sizeof(insertion_candidates) / sizeof(insertion_candidates[0]);
+    int nm = sizeof(median5_candidates) / sizeof(median5_candidates[0]);
+    int nq = sizeof(qsort_candidates) / sizeof(qsort_candidates[0]);
+    tune_field(TUNE_INT, &t->int_params.insertion_threshold, insertion_candidates, ni,
+               src, n, work, "int.insertion_threshold", verbose);
+    tune_field(TUNE_INT, &t->int_params.median5_threshold, median5_candidates, nm,
+               src, n, work, "int.median5_threshold", verbose);
+    tune_field(TUNE_DOUBLE, &t->double_params.insertion_threshold, insertion_candidates, ni,
+               src, n, work, "double.insertion_threshold", verbose);
+    tune_field(TUNE_DOUBLE, &t->double_params.median5_threshold, median5_candidates, nm,
+               src, n, work, "double.median5_threshold", verbose);
+    tune_field(TUNE_QSORT, &t->qsort_params.insertion_threshold, qsort_candidates, nq,
+               src, n, work, "qsort.insertion_threshold", verbose);
+    tune_field(TUNE_QSORT, &t->qsort_params.median5_threshold, median5_candidates, nm,
+               src, n, work, "qsort.median5_threshold", verbose);
+    free(work);
+    free(src);
+}
@@ -0,0 +1,228 @@
+/*
+ * min_max_sort_unique.c
+ *
+ * Совмещённые сортировка + удаление дубликатов и сортировка + подсчёт
+ * по ключам. Сегменты обходятся по порядку значений, поэтому каждый лист
+ * сразу выдаёт свои ключи в выход: равные значения схлопываются при разбиении
+ * (сегмент из одного значения – одна запись), в гистограмме узких диапазонов
+ * и при слиянии, а отсортированный массив целиком не записывается ни разу.
+ */
+
+#include "min_max_sort.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define UNIQUE_STACK_SIZE 128          // до двух отложенных частей на уровень
+#define UNIQUE_LEAF 32                 // размер листа схлопывающего слияния
+
+// Приёмник результата: ключи и (если counts != NULL) их количества.
+// Запись идёт не правее уже прочитанных элементов, поэтому keys может совпадать с arr
+typedef struct {
+    int *keys;
+    int *counts;
+    int out;
+} unique_sink;
+
+static inline void sink_emit(unique_sink *s, int key, int count) {
+    s->keys[s->out] = key;
+    if (s->counts)
+        s->counts[s->out] = count;
+    s->out++;
+}
+
+// Выдача серий равных значений из отсортированного arr[left..right]
+static void sink_emit_runs(unique_sink *s, const int arr[], int left, int right) {
+    int i = left;
+    while (i <= right) {
+        int key = arr[i], j = i + 1;
+        while (j <= right && arr[j] == key)
+            j++;
+        sink_emit(s, key, j - i);
+        i = j;
+    }
+}
+
+// Гистограмма узкого диапазона: ключи выдаются прямо из счётчиков
+static void sink_emit_histogram(unique_sink *s, const int arr[], int left, int right,
+                                int min_value, int max_value) {
+    size_t range = (size_t)((long long)max_value - min_value) + 1;
+    int *count = calloc(range, sizeof(int));
+    if (!count) {
+        fprintf(stderr, "Ошибка выделения памяти в sink_emit_histogram.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = left; i <= right; i++)
+        count[(size_t)((long long)arr[i] - min_value)]++;
+    for (size_t v = 0; v < range; v++)
+        if (count[v])
+            sink_emit(s, (int)(min_value + (long long)v), count[v]);
+    free(count);
+}
+
+// Сортировка слиянием со схлопыванием: a[0..n-1] превращается в возрастающие
+// различные ключи a[0..m-1] (и их количества c[0..m-1], если c != NULL), возвращает m.
+// Каждый уровень сливает уже схлопнутые половины, так что при частых повторах
+// объём слияний быстро падает
+static int collapse_sort(int a[], int c[], int n, int tmp[], int ctmp[]) {
+    if (n <= UNIQUE_LEAF) {
+        hmm_insertion_sort(a, 0, n - 1);
+        int m = 0;
+        for (int i = 0; i < n;) {
+            int j = i + 1;
+            while (j < n && a[j] == a[i])
+                j++;
+            if (c)
+                c[m] = j - i;
+            a[m++] = a[i];
+            i = j;
+        }
+        return m;
+    }
+    int h = n / 2;
+    int n1 = collapse_sort(a, c, h, tmp, ctmp);
+    int n2 = collapse_sort(a + h, c ? c + h : NULL, n - h, tmp, ctmp);
+    int i = 0, j = h, k = 0;
+    while (i < n1 && j < h + n2) {
+        if (a[i] < a[j]) {
+            if (c)
+                ctmp[k] = c[i];
+            tmp[k++] = a[i++];
+        } else if (a[j] < a[i]) {
+            if (c)
+                ctmp[k] = c[j];
+            tmp[k++] = a[j++];
+        } else {
+            if (c)
+                ctmp[k] = c[i] + c[j];
+            tmp[k++] = a[i++];
+            j++;
+        }
+    }
+    while (i < n1) {
+        if (c)
+            ctmp[k] = c[i];
+        tmp[k++] = a[i++];
+    }
+    while (j < h + n2) {
+        if (c)
+            ctmp[k] = c[j];
+        tmp[k++] = a[j++];
+    }
+    for (int p = 0; p < k; p++) {
+        a[p] = tmp[p];
+        if (c)
+            c[p] = ctmp[p];
+    }
+    return k;
+}
+
+// Запасной путь для сегмента: схлопывающее слияние и выдача результата
+static void sink_emit_merge(unique_sink *s, int arr[], int left, int right) {
+    int n = right - left + 1;
+    int with_counts = s->counts != NULL;
+    int *tmp = malloc((size_t)n * (with_counts ? 3 : 1) * sizeof(int));
+    if (!tmp) {
+        fprintf(stderr, "Ошибка выделения памяти в sink_emit_merge.\n");
+        exit(EXIT_FAILURE);
+    }
+    int *c = with_counts ? tmp + n : NULL;
+    int *ctmp = with_counts ? tmp + 2 * (size_t)n : NULL;
+    int m = collapse_sort(arr + left, c, n, tmp, ctmp);
+    for (int i = 0; i < m; i++)
+        sink_emit(s, arr[left + i], c ? c[i] : 1);
+    free(tmp);
+}
+
+// Общий драйвер: тот же выбор опорных и ведение границ значений, что и в
+// hybrid_min_max_sort_serial, но части обрабатываются слева направо (правая и
+// средняя откладываются в стек, цикл продолжается по левой), чтобы выход
+// формировался по возрастанию ключей за один проход по листьям
+static int sort_collapse(int arr[], int n, int keys_out[], int counts_out[]) {
+    int stack_left[UNIQUE_STACK_SIZE], stack_right[UNIQUE_STACK_SIZE];
+    int stack_min[UNIQUE_STACK_SIZE], stack_max[UNIQUE_STACK_SIZE];
+    int stack_depth[UNIQUE_STACK_SIZE];
+    int top = 0;
+    int left = 0, right = n - 1, min_value, max_value;
+    unique_sink sink = { keys_out, counts_out, 0 };
+
+    hmm_tuning_init();
+    if (n <= 0)
+        return 0;
+    if (hmm_prescan_min_max(arr, 0, n - 1, &min_value, &max_value)) {
+        sink_emit_runs(&sink, arr, 0, n - 1);
+        return sink.out;
+    }
+    // Предел глубины 2 * floor(log2 n): стек не переполняется и худший случай
+    // остаётся O(n log n)
+    int max_depth = hmm_depth_limit(n), depth = 0;
+
+    for (;;) {
+        int segment_size = right - left + 1;
+        long long range = (long long)max_value - min_value;
+        if (segment_size <= 0) {
+            // Пустая средняя часть
+        } else if (range == 0) {
+            sink_emit(&sink, min_value, segment_size);
+        } else if (segment_size <= hmm_get_adaptive_threshold(segment_size)) {
+            hmm_insertion_sort(arr, left, right);
+            sink_emit_runs(&sink, arr, left, right);
+        } else if (range < segment_size) {
+            sink_emit_histogram(&sink, arr, left, right, min_value, max_value);
+        } else if (depth >= max_depth) {
+            sink_emit_merge(&sink, arr, left, right);
+        } else {
+            int i_low = hmm_select_lower_pivot(arr, left, right, segment_size);
+            int i_high = hmm_select_upper_pivot(arr, left, right, segment_size);
+            int lowerPivot = arr[i_low], upperPivot = arr[i_high];
+            if (lowerPivot > upperPivot) {
+                int t = lowerPivot;
+                lowerPivot = upperPivot;
+                upperPivot = t;
+            }
+            hmm_nudge_pivots(&lowerPivot, &upperPivot, min_value, max_value);
+            int l, r;
+            hmm_partition_by_pivots(arr, left, right, lowerPivot, upperPivot, &l, &r);
+            if (l == left || r == right) {
+                sink_emit_merge(&sink, arr, left, right);
+            } else {
+                // Средняя часть при lowerPivot == upperPivot состоит из одного
+                // значения и при извлечении из стека выдаётся одной записью
+                stack_left[top] = r + 1;
+                stack_right[top] = right;
+                stack_min[top] = upperPivot + 1;
+                stack_max[top] = max_value;
+                stack_depth[top++] = depth + 1;
+                stack_left[top] = l;
+                stack_right[top] = r;
+                stack_min[top] = lowerPivot;
+                stack_max[top] = upperPivot;
+                stack_depth[top++] = depth + 1;
+                right = l - 1;
+                max_value = lowerPivot - 1;
+                depth++;
+                continue;
+            }
+        }
+        if (top == 0)
+            break;
+        top--;
+        left = stack_left[top];
+        right = stack_right[top];
+        min_value = stack_min[top];
+        max_value = stack_max[top];
+        depth = stack_depth[top];
+    }
+    return sink.out;
+}
+
+// Сортировка с удалением дубликатов: arr[0..new_n-1] – возрастающие различные значения
+int hybrid_min_max_sort_unique(int arr[], int n) {
+    return sort_collapse(arr, n, arr, NULL);
+}
+
+// Сортировка с подсчётом: keys_out[i] – i-й по возрастанию различный ключ,
+// counts_out[i] – число его вхождений. arr переставляется как рабочий буфер,
+// keys_out может совпадать с arr. Возвращает число различных ключей
+int hybrid_min_max_sort_count(int arr[], int n, int keys_out[], int counts_out[]) {
+    return sort_collapse(arr, n, keys_out, counts_out);
+}